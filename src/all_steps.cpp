@@ -20,3 +20,28 @@ void EliminateOneCellInniesAndOutiesStep::anchor() {}
 void EliminateHardInniesAndOutiesStep::anchor() {}
 void PropagateFixedCells::anchor() {}
 void XWingsStep::anchor() {}
+
+void initializeAllSteps(StepList &steps, StepIDMap &step_map) {
+  steps.push_back(std::make_unique<PropagateFixedCells>());
+  steps.push_back(std::make_unique<EliminateImpossibleCombosStep>());
+  steps.push_back(std::make_unique<EliminateNakedPairsStep>());
+  steps.push_back(std::make_unique<EliminateNakedTriplesStep>());
+  steps.push_back(std::make_unique<EliminateNakedQuadsStep>());
+  steps.push_back(std::make_unique<EliminateNakedQuintsStep>());
+  steps.push_back(std::make_unique<EliminateHiddenSinglesStep>());
+  steps.push_back(std::make_unique<EliminateHiddenPairsStep>());
+  steps.push_back(std::make_unique<EliminateHiddenTriplesStep>());
+  steps.push_back(std::make_unique<EliminateHiddenQuadsStep>());
+  steps.push_back(std::make_unique<EliminateCageUnitOverlapStep>());
+  steps.push_back(std::make_unique<EliminateHardCageUnitOverlapStep>());
+  steps.push_back(std::make_unique<EliminatePointingPairsOrTriplesStep>());
+  steps.push_back(std::make_unique<EliminateOneCellInniesAndOutiesStep>());
+  steps.push_back(std::make_unique<EliminateConflictingCombosStep>());
+  steps.push_back(std::make_unique<EliminateHardInniesAndOutiesStep>());
+  steps.push_back(std::make_unique<EliminateHardConflictingCombosStep>());
+  steps.push_back(std::make_unique<XWingsStep>());
+
+  for (auto &step : steps) {
+    step_map[step->getID()] = step.get();
+  }
+}
@@ -10,4 +10,12 @@
 #include "nakeds.h"
 #include "xwings.h"
 
+#include <memory>
+#include <vector>
+
+using StepList = std::vector<std::unique_ptr<ColumboStep>>;
+
+// Creates one of every step, registering each under its ID.
+void initializeAllSteps(StepList &steps, StepIDMap &step_map);
+
 #endif // COLUMBO_ALL_STEPS_H
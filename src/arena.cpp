@@ -0,0 +1,17 @@
+#include "arena.h"
+
+#include <algorithm>
+
+void *Arena::allocateSlow(std::size_t size, std::size_t align) {
+  // Move on to the next chunk, reusing it if it's big enough. Chunks are
+  // aligned for any object, so an empty one needs no padding.
+  if (current < chunks.size())
+    current++;
+  offset = 0;
+  if (current == chunks.size() || chunks[current].size < size) {
+    const std::size_t chunk_size = std::max(ChunkSize, size);
+    chunks.insert(std::begin(chunks) + current,
+                  Chunk{std::make_unique<std::byte[]>(chunk_size), chunk_size});
+  }
+  return allocate(size, align);
+}
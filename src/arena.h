@@ -0,0 +1,72 @@
+#ifndef COLUMBO_ARENA_H
+#define COLUMBO_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Runs an arena-allocated object's destructor, leaving its memory to the
+// arena.
+template <typename T> struct ArenaDeleter {
+  void operator()(T *ptr) const { ptr->~T(); }
+};
+
+template <typename T> using ArenaPtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+// A monotonic allocator for a grid's cages, cage combos and regions. Memory is
+// only ever handed back in bulk: by rewinding to an earlier mark, once every
+// object allocated since has been destroyed, or by resetting the arena between
+// grids. Either way the chunks are kept for reuse.
+class Arena {
+public:
+  // A point to rewind the arena to.
+  struct Mark {
+    std::size_t chunk = 0;
+    std::size_t offset = 0;
+  };
+
+  Arena() = default;
+  Arena(Arena const &) = delete;
+  Arena &operator=(Arena const &) = delete;
+
+  void *allocate(std::size_t size, std::size_t align) {
+    if (current < chunks.size()) {
+      std::size_t start = (offset + align - 1) & ~(align - 1);
+      if (start + size <= chunks[current].size) {
+        offset = start + size;
+        return chunks[current].data.get() + start;
+      }
+    }
+    return allocateSlow(size, align);
+  }
+
+  template <typename T, typename... Args> ArenaPtr<T> make(Args &&...args) {
+    void *mem = allocate(sizeof(T), alignof(T));
+    return ArenaPtr<T>(new (mem) T(std::forward<Args>(args)...));
+  }
+
+  Mark mark() const { return {current, offset}; }
+  void rewind(Mark const &mark) {
+    current = mark.chunk;
+    offset = mark.offset;
+  }
+  void reset() { rewind(Mark{}); }
+
+private:
+  static constexpr std::size_t ChunkSize = 64 * 1024;
+
+  struct Chunk {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size;
+  };
+
+  std::vector<Chunk> chunks;
+  std::size_t current = 0;
+  std::size_t offset = 0;
+
+  void *allocateSlow(std::size_t size, std::size_t align);
+};
+
+#endif // COLUMBO_ARENA_H
@@ -1,8 +1,10 @@
 #include "defs.h"
 #include "step.h"
 
+#include <limits>
+
 void Cage::addCell(Cell *cell) {
-  cells.push_back(cell);
+  cells.addCell(cell);
   if (!is_pseudo)
     cell->cage = this;
   else if (std::find(std::begin(cell->pseudo_cages),
@@ -15,11 +17,30 @@ void Cage::addCell(Grid *const grid, Coord coord) {
   addCell(grid->getCell(coord));
 }
 
-bool Cage::contains(Cell *c) const {
-  return std::find(std::begin(cells), std::end(cells), c) != std::end(cells);
+void CageCells::addCell(Cell *cell) {
+  members.insert(cell->getIndex());
+  cells.push_back(cell);
+}
+
+std::optional<std::size_t> CageCells::indexOf(unsigned idx) const {
+  if (!members.contains(idx))
+    return std::nullopt;
+  for (std::size_t i = 0, e = cells.size(); i != e; i++)
+    if (cells[i]->getIndex() == idx)
+      return i;
+  return std::nullopt;
 }
+
+void CageCells::assign(std::vector<Cell *> new_cells) {
+  cells.clear();
+  members.clear();
+  for (Cell *cell : new_cells)
+    addCell(cell);
+}
+
+bool Cage::contains(Cell *c) const { return cells.contains(c->getIndex()); }
 bool Cage::contains(Cell const *c) const {
-  return std::find(std::begin(cells), std::end(cells), c) != std::end(cells);
+  return cells.contains(c->getIndex());
 }
 
 std::unordered_set<Cell *> Cage::member_set() {
@@ -31,8 +52,7 @@ std::unordered_set<Cell const *> Cage::member_set() const {
 }
 
 bool Cage::overlapsWith(Cage const *c) const {
-  return std::any_of(std::begin(cells), std::end(cells),
-                     [c](Cell *cx) { return c->contains(cx); });
+  return (getCellSet() & c->getCellSet()).any();
 }
 
 bool Cage::doAllCellsSeeEachOther() const {
@@ -51,10 +71,7 @@ bool Cage::areAllCellsAlignedWith(House const &house) const {
 
 // TODO: More efficient way of doing this?
 std::optional<std::size_t> Cage::indexOf(Cell const *cell) const {
-  for (unsigned i = 0, e = size(); i != e; i++)
-    if (cells[i] == cell)
-      return i;
-  return std::nullopt;
+  return cells.indexOf(cell->getIndex());
 }
 
 std::ostream &operator<<(std::ostream &os, const Cage &cage) {
@@ -19,15 +19,7 @@ bool EliminateCageUnitOverlapStep::runOnHouse(House &house, bool debug) {
 
   std::vector<std::pair<Mask, Cage const *>> overlaps;
   for (auto const *cage : cage_list) {
-    std::unordered_set<Mask> unique_combos =
-        cage->cage_combos->getUniqueCombinationsIn(house);
-
-    Mask combined;
-    combined.set();
-
-    for (auto const &subs : unique_combos)
-      combined &= subs;
-
+    Mask combined = cage->cage_combos->getUniqueCombinationsIn(house).common();
     if (combined.any())
       overlaps.push_back(std::make_pair(combined, cage));
   }
@@ -142,10 +134,7 @@ bool EliminateHardCageUnitOverlapStep::runOnHouse(House &house, bool debug) {
     for (auto *cell : house.cells) {
       if (cage->contains(cell))
         continue;
-      Mask mega_mask;
-      mega_mask.set();
-      for (auto combo_mask : cage_combos.getUniqueCombinationsWhichSee(cell))
-        mega_mask &= combo_mask;
+      Mask mega_mask = cage_combos.getUniqueCombinationsWhichSee(cell).common();
       Mask conflicting_candidates = mega_mask & cell->candidates;
       if (conflicting_candidates.any()) {
         if (auto intersection = updateCell(cell, ~conflicting_candidates)) {
@@ -0,0 +1,141 @@
+#ifndef COLUMBO_CELL_SET_H
+#define COLUMBO_CELL_SET_H
+
+#include "grid_tables.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+
+// A set of the grid's cells, by cell index. The 81 cells fit in two 64-bit
+// words, so sets are cheap to copy and combine, and iterate in index order.
+class CellSet {
+public:
+  constexpr CellSet() = default;
+  constexpr CellSet(std::initializer_list<unsigned> cells) {
+    for (unsigned idx : cells)
+      insert(idx);
+  }
+
+  // Iterates over the indices of the cells in the set, lowest first.
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = unsigned;
+    using difference_type = std::ptrdiff_t;
+    using pointer = unsigned const *;
+    using reference = unsigned;
+
+    constexpr iterator(uint64_t lo, uint64_t hi) : lo(lo), hi(hi) {}
+
+    constexpr unsigned operator*() const {
+      return lo ? static_cast<unsigned>(__builtin_ctzll(lo))
+                : 64 + static_cast<unsigned>(__builtin_ctzll(hi));
+    }
+    constexpr iterator &operator++() {
+      if (lo)
+        lo &= lo - 1;
+      else
+        hi &= hi - 1;
+      return *this;
+    }
+    constexpr iterator operator++(int) {
+      iterator it = *this;
+      ++*this;
+      return it;
+    }
+    constexpr bool operator==(iterator const &other) const {
+      return lo == other.lo && hi == other.hi;
+    }
+    constexpr bool operator!=(iterator const &other) const {
+      return !(*this == other);
+    }
+
+  private:
+    uint64_t lo, hi;
+  };
+
+  constexpr iterator begin() const { return iterator{words[0], words[1]}; }
+  constexpr iterator end() const { return iterator{0, 0}; }
+
+  constexpr bool contains(unsigned idx) const {
+    return (words[idx / 64] >> (idx % 64)) & 1;
+  }
+  constexpr std::size_t size() const {
+    return static_cast<std::size_t>(__builtin_popcountll(words[0]) +
+                                    __builtin_popcountll(words[1]));
+  }
+  constexpr bool empty() const { return !(words[0] | words[1]); }
+  constexpr bool any() const { return !empty(); }
+
+  // The lowest cell index in the set. The set must not be empty.
+  constexpr unsigned first() const {
+    assert(!empty() && "Empty set");
+    return *begin();
+  }
+
+  constexpr void insert(unsigned idx) {
+    assert(idx < NumCells && "Cell out of range");
+    words[idx / 64] |= uint64_t{1} << (idx % 64);
+  }
+  constexpr void erase(unsigned idx) {
+    words[idx / 64] &= ~(uint64_t{1} << (idx % 64));
+  }
+  constexpr void clear() { words = {}; }
+
+  constexpr CellSet &operator&=(CellSet const &other) {
+    words[0] &= other.words[0];
+    words[1] &= other.words[1];
+    return *this;
+  }
+  constexpr CellSet &operator|=(CellSet const &other) {
+    words[0] |= other.words[0];
+    words[1] |= other.words[1];
+    return *this;
+  }
+
+  friend constexpr CellSet operator&(CellSet lhs, CellSet const &rhs) {
+    return lhs &= rhs;
+  }
+  friend constexpr CellSet operator|(CellSet lhs, CellSet const &rhs) {
+    return lhs |= rhs;
+  }
+
+  friend constexpr bool operator==(CellSet const &lhs, CellSet const &rhs) {
+    return lhs.words[0] == rhs.words[0] && lhs.words[1] == rhs.words[1];
+  }
+  friend constexpr bool operator!=(CellSet const &lhs, CellSet const &rhs) {
+    return !(lhs == rhs);
+  }
+
+  constexpr std::size_t hash() const {
+    return static_cast<std::size_t>(words[0] * 0x9E3779B97F4A7C15ull ^
+                                    words[1]);
+  }
+
+private:
+  std::array<uint64_t, 2> words = {};
+};
+
+// The cells of each house, as a set.
+inline constexpr std::array<CellSet, NumHouses> HouseCellSets = [] {
+  std::array<CellSet, NumHouses> houses{};
+  for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++)
+    for (unsigned idx : HouseCells[house_idx])
+      houses[house_idx].insert(idx);
+  return houses;
+}();
+
+namespace std {
+template <> struct hash<CellSet> {
+  std::size_t operator()(CellSet const &set) const noexcept {
+    return set.hash();
+  }
+};
+} // namespace std
+
+#endif // COLUMBO_CELL_SET_H
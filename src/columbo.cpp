@@ -1,13 +1,21 @@
 #include "all_steps.h"
 #include "cli.h"
 #include "defs.h"
+#include "search.h"
 #include "strategy.h"
 #include "printers/terminal_printer.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <glob.h>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unistd.h>
 
 static bool QUIET = false;
@@ -18,20 +26,46 @@ static void print_help() {
 
     Usage:
       columbo [option] -f <sudoku file>
+      columbo [option] -b <sudoku file|directory|glob|@list file|->
 
     Options:
       -h                                   Print help and exit
       -f    --file <sudoku file>           Use <sudoku file> as input
+      -b    --batch <path>                 Solve many sudokus, printing one line
+                                             per sudoku. <path> may be a
+                                             sudoku file, a directory, a quoted
+                                             glob, or '@' followed by a file
+                                             listing one sudoku per line ('-'
+                                             reads the list from stdin). May be
+                                             set multiple times.
+      -j    --jobs <N>                     Solve batches using <N> threads. 0
+                                             uses one per hardware thread.
       -o           <sudoku file>           Write <sudoku file> as output
                                              Can provide '-' for stdout
             --print-before-all             Print grid before every, step
             --print-before=step1,step2,..  Print grid before steps, if changed
             --print-after-all              Print grid after every step, if changed
             --print-after=step1,step2,..   Print grid after steps, if changed
-      -t    --time                         Print detailed timing information
+      -t    --time[=csv|json]              Once solving finishes, print a
+                                             profile of every step run (over
+                                             all sudokus, in batch mode) as CSV
+                                             (the default) or JSON
       -d    --debug                        Print debug text for every step
       -s    --run-step <step>              Run <step>. May be set multiple times.
                                              Steps are run in order passed.
+            --search <guess|dlx>           If the steps get stuck, search for a
+                                             solution by guessing or with an
+                                             exact cover (dancing links) solver
+            --search-timeout <ms>          Give up after <ms> milliseconds
+                                             (default 10000). The time limit
+                                             covers the steps run before the
+                                             search as well as the search
+            --count-solutions[=N]          Count the sudoku's solutions,
+                                             stopping once N (default 2) have
+                                             been found. Searches with the
+                                             --search engine (default guess)
+            --rate                         Rate the sudoku's difficulty from
+                                             the steps it needed
             --rowcol                       Print grid in row/col format
       -q    --quiet                        Print nothing at all
             --no-colour                    Don't print grids using colour
@@ -39,34 +73,6 @@ static void print_help() {
   )";
 }
 
-using StepList = std::vector<std::unique_ptr<ColumboStep>>;
-
-static void initializeAllSteps(const Grid *, StepList &steps,
-                               StepIDMap &step_map) {
-  steps.push_back(std::make_unique<PropagateFixedCells>());
-  steps.push_back(std::make_unique<EliminateImpossibleCombosStep>());
-  steps.push_back(std::make_unique<EliminateNakedPairsStep>());
-  steps.push_back(std::make_unique<EliminateNakedTriplesStep>());
-  steps.push_back(std::make_unique<EliminateNakedQuadsStep>());
-  steps.push_back(std::make_unique<EliminateNakedQuintsStep>());
-  steps.push_back(std::make_unique<EliminateHiddenSinglesStep>());
-  steps.push_back(std::make_unique<EliminateHiddenPairsStep>());
-  steps.push_back(std::make_unique<EliminateHiddenTriplesStep>());
-  steps.push_back(std::make_unique<EliminateHiddenQuadsStep>());
-  steps.push_back(std::make_unique<EliminateCageUnitOverlapStep>());
-  steps.push_back(std::make_unique<EliminateHardCageUnitOverlapStep>());
-  steps.push_back(std::make_unique<EliminatePointingPairsOrTriplesStep>());
-  steps.push_back(std::make_unique<EliminateOneCellInniesAndOutiesStep>());
-  steps.push_back(std::make_unique<EliminateConflictingCombosStep>());
-  steps.push_back(std::make_unique<EliminateHardInniesAndOutiesStep>());
-  steps.push_back(std::make_unique<EliminateHardConflictingCombosStep>());
-  steps.push_back(std::make_unique<XWingsStep>());
-
-  for (auto &step : steps) {
-    step_map[step->getID()] = step.get();
-  }
-}
-
 static std::vector<std::string> split(const std::string &str,
                                       const char delim) {
   std::vector<std::string> tokens;
@@ -83,10 +89,322 @@ static std::vector<std::string> split(const std::string &str,
   return tokens;
 }
 
+// Reads a list of sudoku files, one per line. Blank lines and lines starting
+// with '#' are ignored. Relative paths are taken relative to 'base_dir'.
+static void readFileList(std::istream &list,
+                         std::filesystem::path const &base_dir,
+                         std::vector<std::string> &files) {
+  std::string line;
+  while (std::getline(list, line)) {
+    auto begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos || line[begin] == '#')
+      continue;
+    auto end = line.find_last_not_of(" \t\r");
+    std::filesystem::path path = line.substr(begin, end + 1 - begin);
+    if (path.is_relative())
+      path = base_dir / path;
+    files.push_back(path.lexically_normal().string());
+  }
+}
+
+// Expands a --batch argument into the list of sudoku files it names.
+static bool collectBatchFiles(std::string const &arg,
+                              std::vector<std::string> &files) {
+  namespace fs = std::filesystem;
+
+  if (arg == "-") {
+    readFileList(std::cin, fs::path{}, files);
+    return false;
+  }
+
+  if (arg.find_first_of("*?[") != std::string::npos) {
+    glob_t glob_result;
+    int err = glob(arg.c_str(), 0, nullptr, &glob_result);
+    if (err == 0)
+      files.insert(std::end(files), glob_result.gl_pathv,
+                   glob_result.gl_pathv + glob_result.gl_pathc);
+    globfree(&glob_result);
+    if (err != 0 && err != GLOB_NOMATCH) {
+      std::cerr << "Could not expand glob '" << arg << "'...\n";
+      return true;
+    }
+    return false;
+  }
+
+  std::error_code ec;
+  if (fs::is_directory(arg, ec)) {
+    std::vector<std::string> dir_files;
+    for (auto const &entry : fs::directory_iterator(arg, ec))
+      if (entry.is_regular_file() && entry.path().extension() == ".txt")
+        dir_files.push_back(entry.path().string());
+    // Directory iteration order is unspecified; keep the output stable.
+    std::sort(std::begin(dir_files), std::end(dir_files));
+    files.insert(std::end(files), std::begin(dir_files), std::end(dir_files));
+    return false;
+  }
+
+  if (arg[0] == '@') {
+    std::string list_name = arg.substr(1);
+    std::ifstream list_file(list_name);
+    if (!list_file.is_open()) {
+      std::cerr << "Could not open file '" << list_name << "'...\n";
+      return true;
+    }
+    readFileList(list_file, fs::path(list_name).parent_path(), files);
+    return false;
+  }
+
+  if (!fs::is_regular_file(arg, ec)) {
+    std::cerr << "Could not open file '" << arg << "'...\n";
+    return true;
+  }
+  files.push_back(arg);
+  return false;
+}
+
+enum class SolveStatus { Complete, Stuck, Invalid, Error };
+
+static const char *getStatusName(SolveStatus status) {
+  switch (status) {
+  case SolveStatus::Complete:
+    return "complete";
+  case SolveStatus::Stuck:
+    return "stuck";
+  case SolveStatus::Invalid:
+    return "invalid";
+  case SolveStatus::Error:
+    return "error";
+  }
+  return "unknown";
+}
+
+// Mirrors the exit codes of a single-file run.
+static int getStatusRetCode(SolveStatus status) {
+  switch (status) {
+  case SolveStatus::Complete:
+    return 0;
+  case SolveStatus::Stuck:
+  case SolveStatus::Error:
+    return 1;
+  case SolveStatus::Invalid:
+    return 9;
+  }
+  return 1;
+}
+
+// Prints e.g. "1 solution" or, if the count stopped at the limit, "2+
+// solutions".
+static Printable printSolutionCount(SearchStats const &stats,
+                                    SearchOptions const &opts) {
+  const unsigned n = stats.num_solutions;
+  const bool at_limit = n >= opts.max_solutions;
+  return Printable([n, at_limit](std::ostream &os) {
+    os << n << (at_limit ? "+" : "") << " solution"
+       << (n == 1 && !at_limit ? "" : "s");
+  });
+}
+
+struct SolveResult {
+  SolveStatus status = SolveStatus::Error;
+  Stats stats;
+  SearchStats search_stats;
+  std::optional<Rating> rating;
+  double time_ms = 0;
+};
+
+// The steps and strategy used to solve grids. Steps keep state while running
+// on a grid, so each solving thread owns its own.
+struct Solver {
+  StepList steps;
+  StepIDMap step_map;
+  Strategy strat;
+  std::optional<SearchOptions> search;
+  bool count_solutions = false;
+  bool rate = false;
+  Profile profile;
+
+  bool initialize(std::vector<std::string> const &steps_to_run) {
+    initializeAllSteps(steps, step_map);
+    if (steps_to_run.empty())
+      return strat.initializeDefault(step_map);
+    return strat.initializeWithSteps(steps_to_run, step_map);
+  }
+};
+
+static SolveResult &finishResult(SolveResult &result,
+                                 std::chrono::steady_clock::time_point start) {
+  auto end = std::chrono::steady_clock::now();
+  result.time_ms =
+      std::chrono::duration<double, std::milli>(end - start).count();
+  return result;
+}
+
+// Solves one sudoku file with an already-initialized solver, as used by the
+// batch mode. The steps are shared between sudokus so must be reset first.
+static SolveResult solveOne(std::string const &file_name, Solver &solver,
+                            DebugOptions const &dbg_opts) {
+  SolveResult result;
+  auto start = std::chrono::steady_clock::now();
+
+  std::ifstream sudoku_file(file_name);
+  if (!sudoku_file.is_open()) {
+    std::cerr << "Could not open file '" << file_name << "'...\n";
+    return result;
+  }
+
+  // Each thread reuses one arena for all of its grids.
+  thread_local Arena arena;
+  arena.reset();
+  auto grid = std::make_unique<Grid>(&arena);
+  if (grid->initialize(sudoku_file)) {
+    std::cerr << "Invalid grid '" << file_name << "'...\n";
+    return result;
+  }
+
+  for (auto &step : solver.steps)
+    step->reset();
+
+  if (solver.count_solutions) {
+    result.search_stats =
+        countSolutions(grid.get(), solver.strat, *solver.search, dbg_opts);
+    result.status = result.search_stats.timed_out ? SolveStatus::Stuck
+                                                  : SolveStatus::Complete;
+    return finishResult(result, start);
+  }
+
+  // Only the logical steps are rated: those run between guesses don't say
+  // how hard the sudoku is.
+  if (solver.rate) {
+    result.rating.emplace();
+    solver.strat.rating = &*result.rating;
+  }
+
+  if (solver.search)
+    solver.strat.deadline = startDeadline(*solver.search);
+  try {
+    result.stats = solver.strat.solveGrid(grid.get(), dbg_opts);
+    solver.strat.rating = nullptr;
+    if (!result.stats.is_complete && solver.search) {
+      result.search_stats =
+          searchGrid(grid.get(), solver.strat, *solver.search, dbg_opts);
+      if (!result.search_stats.is_complete && !result.search_stats.timed_out)
+        throw invalid_grid_exception{"no solution"};
+      result.stats.is_complete = result.search_stats.is_complete;
+      if (result.rating && result.search_stats.num_guesses)
+        result.rating->recordSearch();
+    }
+    result.status =
+        result.stats.is_complete ? SolveStatus::Complete : SolveStatus::Stuck;
+  } catch (invalid_grid_exception &e) {
+    solver.strat.rating = nullptr;
+    result.status = SolveStatus::Invalid;
+  }
+  solver.strat.deadline.reset();
+
+  return finishResult(result, start);
+}
+
+// Solves the sudokus on 'num_jobs' threads. Each thread claims the next
+// unsolved sudoku in turn, so a long solve on one thread never holds up the
+// others. Results are printed in input order as soon as they're available.
+static int solveBatch(std::vector<std::string> const &files,
+                      std::vector<std::string> const &steps_to_run,
+                      std::optional<SearchOptions> const &search,
+                      bool count_solutions, bool rate,
+                      std::optional<ProfileFormat> profile_format,
+                      DebugOptions const &dbg_opts, unsigned num_jobs) {
+  std::vector<SolveResult> results(files.size());
+  std::vector<bool> is_done(files.size(), false);
+  std::atomic<std::size_t> next_file = 0;
+  std::mutex results_mutex;
+  std::condition_variable results_cv;
+  Profile profile;
+
+  auto worker = [&, use_colour = USE_COLOUR, use_rowcol = USE_ROWCOL]() {
+    // These are per-thread; inherit whatever the command line asked for.
+    USE_COLOUR = use_colour;
+    USE_ROWCOL = use_rowcol;
+
+    // The strategy has already been validated by the main thread.
+    Solver solver;
+    solver.initialize(steps_to_run);
+    solver.search = search;
+    solver.count_solutions = count_solutions;
+    solver.rate = rate;
+    if (profile_format)
+      solver.strat.profile = &solver.profile;
+
+    for (std::size_t i = next_file++; i < files.size(); i = next_file++) {
+      SolveResult result = solveOne(files[i], solver, dbg_opts);
+      {
+        std::lock_guard<std::mutex> lock(results_mutex);
+        results[i] = result;
+        is_done[i] = true;
+      }
+      results_cv.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(results_mutex);
+    profile.merge(solver.profile);
+  };
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (unsigned j = 0; j < num_jobs; j++)
+    workers.emplace_back(worker);
+
+  int ret = 0;
+  unsigned num_complete = 0;
+  for (std::size_t i = 0, e = files.size(); i != e; i++) {
+    SolveResult result;
+    {
+      std::unique_lock<std::mutex> lock(results_mutex);
+      results_cv.wait(lock, [&is_done, i]() { return is_done[i]; });
+      result = results[i];
+    }
+    std::cout << getStatusName(result.status) << ' ';
+    if (count_solutions)
+      std::cout << printSolutionCount(result.search_stats, *search);
+    else
+      std::cout << result.stats.num_useful_steps << '/'
+                << result.stats.num_steps;
+    if (result.rating)
+      std::cout << " rated " << printRating(*result.rating);
+    std::cout << ' ' << result.time_ms << "ms " << files[i] << '\n';
+    ret = std::max(ret, getStatusRetCode(result.status));
+    num_complete += result.status == SolveStatus::Complete;
+  }
+
+  for (auto &t : workers)
+    t.join();
+
+  if (!QUIET) {
+    auto end = std::chrono::steady_clock::now();
+    auto diff_ms =
+        std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "Completed " << num_complete << "/" << files.size()
+              << " sudokus in " << diff_ms << "ms\n";
+  }
+
+  if (profile_format)
+    profile.write(std::cout, *profile_format);
+
+  return ret;
+}
+
 int main(int argc, char *argv[]) {
   const char *file_name = nullptr;
   const char *out_file_name = nullptr;
   std::vector<std::string> steps_to_run;
+  std::vector<std::string> batch_files;
+  bool batch_mode = false;
+  bool rate = false;
+  std::optional<ProfileFormat> profile_format;
+  unsigned num_jobs = 1;
+  std::optional<SearchOptions> search;
+  std::chrono::milliseconds search_timeout = *SearchOptions().time_limit;
+  std::optional<unsigned> count_solutions;
 
   DebugOptions dbg_opts;
 
@@ -104,8 +422,10 @@ int main(int argc, char *argv[]) {
       }
       auto steps = split(argv[++i], ',');
       dbg_opts.debug_types.insert(std::begin(steps), std::end(steps));
-    } else if (isOpt(opt, "-t", "--time")) {
-      TIME = true;
+    } else if (isOpt(opt, "-t", "--time") || isOpt(opt, "", "--time=csv")) {
+      profile_format = ProfileFormat::CSV;
+    } else if (isOpt(opt, "", "--time=json")) {
+      profile_format = ProfileFormat::JSON;
     } else if (isOpt(opt, "", "--print-after")) {
       if (i + 1 >= argc) {
         std::cerr << "Expected a value to option '" << opt << "'...\n";
@@ -124,6 +444,8 @@ int main(int argc, char *argv[]) {
       dbg_opts.print_before_steps.insert(std::begin(steps), std::end(steps));
     } else if (isOpt(opt, "", "--print-before-all")) {
       dbg_opts.print_before_all = true;
+    } else if (isOpt(opt, "", "--rate")) {
+      rate = true;
     } else if (isOpt(opt, "", "--no-colour")) {
       USE_COLOUR = false;
     } else if (isOpt(opt, "-f", "--file")) {
@@ -133,6 +455,27 @@ int main(int argc, char *argv[]) {
       }
       file_name = argv[i + 1];
       ++i;
+    } else if (isOpt(opt, "-b", "--batch")) {
+      if (i + 1 >= argc) {
+        std::cerr << "Expected a value to option '" << opt << "'...\n";
+        return 1;
+      }
+      batch_mode = true;
+      if (collectBatchFiles(argv[++i], batch_files))
+        return 1;
+    } else if (isOpt(opt, "-j", "--jobs")) {
+      if (i + 1 >= argc) {
+        std::cerr << "Expected a value to option '" << opt << "'...\n";
+        return 1;
+      }
+      char *end = nullptr;
+      num_jobs = static_cast<unsigned>(std::strtoul(argv[++i], &end, 10));
+      if (*end != '\0') {
+        std::cerr << "Invalid number of jobs '" << argv[i] << "'...\n";
+        return 1;
+      }
+      if (num_jobs == 0)
+        num_jobs = std::max(1u, std::thread::hardware_concurrency());
     } else if (isOpt(opt, "-o", "")) {
       if (i + 1 >= argc) {
         std::cerr << "Expected a value to option '" << opt << "'...\n";
@@ -147,6 +490,44 @@ int main(int argc, char *argv[]) {
       }
       steps_to_run.push_back(argv[i + 1]);
       ++i;
+    } else if (isOpt(opt, "", "--search")) {
+      if (i + 1 >= argc) {
+        std::cerr << "Expected a value to option '" << opt << "'...\n";
+        return 1;
+      }
+      search = SearchOptions();
+      if (std::strcmp(argv[++i], "guess") == 0) {
+        search->engine = SearchEngine::Guess;
+      } else if (std::strcmp(argv[i], "dlx") == 0) {
+        search->engine = SearchEngine::DLX;
+      } else {
+        std::cerr << "Unknown search engine '" << argv[i] << "'...\n";
+        return 1;
+      }
+    } else if (isOpt(opt, "", "--search-timeout")) {
+      if (i + 1 >= argc) {
+        std::cerr << "Expected a value to option '" << opt << "'...\n";
+        return 1;
+      }
+      char *end = nullptr;
+      search_timeout =
+          std::chrono::milliseconds(std::strtoul(argv[++i], &end, 10));
+      if (*end != '\0') {
+        std::cerr << "Invalid search timeout '" << argv[i] << "'...\n";
+        return 1;
+      }
+    } else if (std::string_view arg = opt;
+               arg.substr(0, arg.find('=')) == "--count-solutions") {
+      count_solutions = 2;
+      if (auto eq = arg.find('='); eq != std::string_view::npos) {
+        char *end = nullptr;
+        count_solutions =
+            static_cast<unsigned>(std::strtoul(opt + eq + 1, &end, 10));
+        if (*end != '\0' || *count_solutions == 0) {
+          std::cerr << "Invalid solution count '" << opt + eq + 1 << "'...\n";
+          return 1;
+        }
+      }
     } else if (isOpt(opt, "-h", "--help")) {
       print_help();
       return 0;
@@ -161,7 +542,7 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  if (!file_name) {
+  if (!file_name && !batch_mode) {
     std::cerr << "Did not specify a file name\n";
     print_help();
     return 1;
@@ -172,6 +553,42 @@ int main(int argc, char *argv[]) {
     dbg_opts.print_after_all = false;
   }
 
+  if (count_solutions && !search)
+    search = SearchOptions();
+
+  if (search) {
+    search->time_limit = search_timeout;
+    search->max_solutions = count_solutions.value_or(1);
+  }
+
+  if (batch_mode) {
+    if (out_file_name) {
+      std::cerr << "Cannot write an output file in batch mode\n";
+      return 1;
+    }
+
+    if (num_jobs > 1 &&
+        (dbg_opts.debug_all || dbg_opts.print_after_all ||
+         dbg_opts.print_before_all || !dbg_opts.debug_types.empty() ||
+         !dbg_opts.print_after_steps.empty() ||
+         !dbg_opts.print_before_steps.empty())) {
+      std::cerr << "Cannot debug or print grids with more than one job\n";
+      return 1;
+    }
+
+    if (file_name)
+      batch_files.insert(std::begin(batch_files), file_name);
+
+    if (Solver().initialize(steps_to_run)) {
+      std::cerr << "Could not initialize strategy\n";
+      return 1;
+    }
+
+    return solveBatch(batch_files, steps_to_run, search,
+                      count_solutions.has_value(), rate, profile_format,
+                      dbg_opts, num_jobs);
+  }
+
   std::ifstream sudoku_file;
   sudoku_file.open(file_name);
 
@@ -196,7 +613,7 @@ int main(int argc, char *argv[]) {
 
   StepList steps;
   StepIDMap step_map;
-  initializeAllSteps(grid.get(), steps, step_map);
+  initializeAllSteps(steps, step_map);
 
   Strategy strat;
   bool err = false;
@@ -211,11 +628,45 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
+  Profile profile;
+  if (profile_format)
+    strat.profile = &profile;
+
+  if (count_solutions) {
+    SearchStats search_stats =
+        countSolutions(grid.get(), strat, *search, dbg_opts);
+    if (profile_format)
+      profile.write(std::cout, *profile_format);
+    std::cout << "Found " << printSolutionCount(search_stats, *search)
+              << "\n";
+    if (search_stats.timed_out) {
+      std::cout << "Search timed out after " << search_stats.num_guesses
+                << " guesses\n";
+      return 1;
+    }
+    return 0;
+  }
+
   Stats stats;
+  SearchStats search_stats;
+  Rating rating;
   bool error = false;
   std::string error_msg;
+  if (rate)
+    strat.rating = &rating;
+  if (search)
+    strat.deadline = startDeadline(*search);
   try {
     stats = strat.solveGrid(grid.get(), dbg_opts);
+    strat.rating = nullptr;
+    if (!stats.is_complete && search) {
+      search_stats = searchGrid(grid.get(), strat, *search, dbg_opts);
+      if (!search_stats.is_complete && !search_stats.timed_out)
+        throw invalid_grid_exception{"no solution"};
+      stats.is_complete = search_stats.is_complete;
+      if (search_stats.num_guesses)
+        rating.recordSearch();
+    }
   } catch (invalid_grid_exception &e) {
     error = true;
     error_msg = e.msg;
@@ -237,6 +688,16 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (profile_format)
+    profile.write(std::cout, *profile_format);
+
+  if (rate && !error && !QUIET) {
+    std::cout << "Rated " << printRating(rating) << "\n";
+    for (auto const &[id, usage] : rating.steps)
+      std::cout << "  " << id << ": " << usage.num_useful << " useful, "
+                << usage.num_eliminations << " eliminated\n";
+  }
+
   if (error) {
     std::cerr << "Found a bad (invalid) grid: " << error_msg << "\n";
     return 9;
@@ -244,8 +705,14 @@ int main(int argc, char *argv[]) {
     if (!QUIET) {
       std::cout << "Complete in " << stats.num_useful_steps << "/"
                 << stats.num_steps << " steps!\n";
+      if (search_stats.num_guesses)
+        std::cout << "Searched " << search_stats.num_guesses << " guesses ("
+                  << search_stats.num_backtracks << " backtracks)\n";
     }
-  } else if (steps_to_run.empty()) {
+  } else if (steps_to_run.empty() || search) {
+    if (search_stats.timed_out)
+      std::cout << "Search timed out after " << search_stats.num_guesses
+                << " guesses\n";
     std::cout << "Stuck after " << stats.num_useful_steps << "/"
               << stats.num_steps << " steps!\n";
     return 1;
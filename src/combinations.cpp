@@ -5,115 +5,79 @@
 #include <cassert>
 #include <iostream>
 #include <numeric>
+#include <optional>
+#include <unordered_map>
 #include <unordered_set>
 
-// Given a list of lists of possible cage values:
-//     [{1,2,3}, {3,4,5}]
-// Recursively generates tuples of combinations from each of the lists as
-// follows:
-//   [1,3]
-//   [1,4]
-//   [1,5]
-//   [2,3]
-//   [2,4]
-// ... etc
-// Each of these is checked against the target sum, and pushed into a result
-// vector if they match.
-// Note: The algorithm assumes that the list of possibles/candidates are
-// ordered. This allows it to bail out early if it detects there's no point
-// going further.
-static void subsetSum(const std::vector<Mask> &possible_lists,
-                      Mask const current_combo, unsigned tuple_sum,
-                      std::vector<CageCombo> &subsets,
-                      const unsigned target_sum, unsigned list_idx) {
-  std::size_t const p_size = possible_lists.size();
-  std::size_t const m_size = possible_lists[0].size();
-  for (unsigned p = list_idx; p < p_size; ++p) {
-    for (unsigned i = 0; i != m_size; ++i) {
-      if (!possible_lists[p][i])
-        continue;
-      // Can't repeat a value inside a cage
-      if (current_combo[i])
-        continue;
-
-      auto poss = i + 1;
-      // Optimization for small target sums: if the candidate is bigger than
-      // the target itself then it can't be valid, neither can any candidate
-      // after it (ordered).
-      if (target_sum < static_cast<unsigned>(poss)) {
-        break;
-      }
-
-      // If the running total plus all the minimums of the remaining candidates
-      // is guaranteed to exceed the sum, bail out here (ordered).
-      if (std::accumulate(possible_lists.begin() + p + 1, possible_lists.end(),
-                          tuple_sum + poss, [](const unsigned A, const Mask B) {
-                            return A + min_value(B);
-                          }) > target_sum) {
-        break;
-      }
-
-      // If the running total plus all the maximums of the remaining candidates
-      // is insufficient to reach the target, skip this candidate and try a
-      // larger one.
-      if (std::accumulate(possible_lists.begin() + p + 1, possible_lists.end(),
-                          tuple_sum + poss, [](const unsigned A, const Mask B) {
-                            return A + max_value(B);
-                          }) < target_sum) {
-        continue;
-      }
-
-      // Pre-calculate the new tuple values to avoid spurious
-      // insertions/deletions to the vector.
-      const auto new_tuple_sum = tuple_sum + poss;
-      const auto new_tuple_size = current_combo.count() + 1;
+static constexpr unsigned MaxSum = 45;
 
-      // If we've added too much then we can bail out (ordered).
-      if (new_tuple_sum > target_sum) {
-        break;
-      }
+// Every combination of distinct values 1-9, grouped by size then sum. The
+// combinations of a given size and sum are combos[start[key]] up to
+// combos[start[key + 1]], where key is comboKey(size, sum).
+struct CombinationTable {
+  std::array<Mask, Mask::AllBits> combos = {};
+  std::array<uint16_t, 10 * (MaxSum + 1) + 1> start = {};
+};
 
-      // If there are fewer spots left in the tuple than there are options for
-      // the sum to reach the target, bail.
-      // TODO: This could be more sophisticated (can't have more than one 1, so
-      // it's more like the N-1 sum that it should be greater than.
-      if ((p_size - new_tuple_size) > (target_sum - new_tuple_sum))
-        break;
-
-      if (new_tuple_size == p_size) {
-        // If we've reached our target size then we can stop searching other
-        // possiblities from this list (ordered).
-        auto m = current_combo | Mask(1 << i);
-        if (new_tuple_sum == target_sum &&
-            std::find_if(std::begin(subsets), std::end(subsets),
-                         [m](CageCombo const &c) { return c.combo == m; }) ==
-                std::end(subsets)) {
-          subsets.push_back(CageCombo{m});
-          break;
-        }
-
-        // Else, move on to the next candidate in the list.
-        continue;
-      }
+static constexpr unsigned comboKey(unsigned size, unsigned sum) {
+  return size * (MaxSum + 1) + sum;
+}
 
-      tuple_sum += poss;
-      subsetSum(possible_lists, current_combo | Mask(1 << i), tuple_sum,
-                subsets, target_sum, p + 1);
-      tuple_sum -= poss;
+static constexpr unsigned comboKey(unsigned bits) {
+  unsigned size = 0, sum = 0;
+  for (unsigned i = 0; i < 9; i++) {
+    if (bits & (1 << i)) {
+      size++;
+      sum += i + 1;
     }
   }
+  return comboKey(size, sum);
+}
+
+static constexpr CombinationTable makeCombinationTable() {
+  CombinationTable table;
+  for (unsigned bits = 1; bits <= Mask::AllBits; bits++)
+    table.start[comboKey(bits) + 1]++;
+  for (unsigned key = 1; key < table.start.size(); key++)
+    table.start[key] += table.start[key - 1];
+  auto next = table.start;
+  for (unsigned bits = 1; bits <= Mask::AllBits; bits++)
+    table.combos[next[comboKey(bits)]++] = Mask(bits);
+  return table;
 }
 
+static constexpr CombinationTable Combinations = makeCombinationTable();
+
+// Looks up the combinations of distinct values adding up to target_sum with
+// one value per list of possibles, keeping those which only use possible
+// values and which leave every list a possible value. Note that this doesn't
+// check that the lists can take the combination's values all at once.
 std::vector<CageCombo>
 generateCageSubsetSums(const unsigned target_sum,
                        const std::vector<Mask> &possibles) {
-  Mask current_combo;
   std::vector<CageCombo> subsets;
-  subsetSum(possibles, current_combo, 0, subsets, target_sum, 0);
+  if (possibles.size() > 9 || target_sum > MaxSum)
+    return subsets;
+
+  Mask all_possibles = 0;
+  for (Mask m : possibles)
+    all_possibles |= m;
+
+  const unsigned key = comboKey(possibles.size(), target_sum);
+  for (unsigned i = Combinations.start[key], e = Combinations.start[key + 1];
+       i != e; i++) {
+    const Mask combo = Combinations.combos[i];
+    if ((combo & ~all_possibles).any() ||
+        std::any_of(std::begin(possibles), std::end(possibles),
+                    [combo](Mask m) { return (m & combo).none(); }))
+      continue;
+    subsets.push_back(CageCombo{combo});
+  }
   return subsets;
 }
 
-std::unique_ptr<CageComboInfo> generateCageComboInfo(Cage const *cage) {
+ArenaPtr<CageComboInfo> generateCageComboInfo(Arena &arena,
+                                               Cage const *cage) {
   std::vector<Mask> possibles;
   possibles.reserve(cage->cells.size());
   for (auto const *cell : cage->cells)
@@ -124,7 +88,22 @@ std::unique_ptr<CageComboInfo> generateCageComboInfo(Cage const *cage) {
   for (CageCombo &cage_combo : subsets)
     expandComboPermutations(cage, cage_combo);
 
-  return std::make_unique<CageComboInfo>(cage, std::move(subsets));
+  // Drop the combinations the cells can't take all at once, and order the
+  // rest by their first permutation.
+  subsets.erase(std::remove_if(std::begin(subsets), std::end(subsets),
+                               [](CageCombo const &cage_combo) {
+                                 return cage_combo.getPermutations().empty();
+                               }),
+                std::end(subsets));
+  std::sort(std::begin(subsets), std::end(subsets),
+            [](CageCombo const &lhs, CageCombo const &rhs) {
+              Permutation l = *lhs.getPermutations().begin();
+              Permutation r = *rhs.getPermutations().begin();
+              return std::lexicographical_compare(l.begin(), l.end(),
+                                                  r.begin(), r.end());
+            });
+
+  return arena.make<CageComboInfo>(cage, std::move(subsets));
 }
 
 static bool hasClash(IntList const &tuple, int tuple_index, int candidate,
@@ -135,18 +114,34 @@ static bool hasClash(IntList const &tuple, int tuple_index, int candidate,
   return false;
 }
 
+// Where to find each combo in a list of combos being built up, keyed by its
+// values and its repeated values.
+using ComboIndex = std::unordered_map<unsigned long, std::size_t>;
+
+// Adds the permutation to the combo with the same values, and the same
+// repeated values, creating it if need be.
+static void addToCombo(std::vector<CageCombo> &subsets, ComboIndex &index,
+                       Mask combo, Mask duplicates, IntList const &tuple) {
+  auto [it, inserted] = index.try_emplace(
+      combo.to_ulong() | duplicates.to_ulong() << 9, subsets.size());
+  if (inserted) {
+    subsets.push_back(CageCombo{combo});
+    subsets.back().duplicates = duplicates;
+  }
+  subsets[it->second].addPermutation(tuple);
+}
+
 static void subsetSumWithDuplicates(const std::vector<Mask> &possible_lists,
                                     const std::vector<CellMask> &clashes,
                                     IntList &tuple, unsigned tuple_sum,
+                                    Mask combo, Mask duplicates,
                                     std::vector<CageCombo> &subsets,
+                                    ComboIndex &index,
                                     const unsigned target_sum,
                                     unsigned list_idx) {
   std::size_t const p_size = possible_lists.size();
-  std::size_t const m_size = possible_lists[0].size();
   for (unsigned p = list_idx; p < p_size; ++p) {
-    for (unsigned i = 0; i != m_size; ++i) {
-      if (!possible_lists[p][i])
-        continue;
+    for (unsigned i : possible_lists[p]) {
       auto poss = i + 1;
       // Can't repeat a value inside a cage if those cells see each other.
       if (hasClash(tuple, p, poss, clashes))
@@ -181,6 +176,8 @@ static void subsetSumWithDuplicates(const std::vector<Mask> &possible_lists,
       // insertions/deletions to the vector.
       const auto new_tuple_sum = tuple_sum + poss;
       const auto new_tuple_size = tuple.size() + 1;
+      const Mask new_combo = combo | Mask(1 << i);
+      const Mask new_duplicates = duplicates | (combo & Mask(1 << i));
 
       // If we've added too much then we can bail out (ordered).
       if (new_tuple_sum > target_sum) {
@@ -200,27 +197,7 @@ static void subsetSumWithDuplicates(const std::vector<Mask> &possible_lists,
         // possiblities from this list (ordered).
         if (new_tuple_sum == target_sum) {
           tuple.push_back(poss);
-          // FIXME: This is dumb. We're finding the CageCombo which this
-          // permutation fits in using a linear search. Surely we can keep
-          // track of this as we go?
-          Mask combo = 0, duplicates = 0;
-          for (auto t : tuple) {
-            if (combo[t - 1])
-              duplicates.set(t - 1);
-            combo.set(t - 1);
-          }
-          CageCombo c{combo};
-          auto it = std::find_if(std::begin(subsets), std::end(subsets),
-                                 [&](CageCombo const &cage_combo) {
-                                   return cage_combo.combo == combo &&
-                                          cage_combo.duplicates == duplicates;
-                                 });
-          if (it != std::end(subsets)) {
-            it->addPermutation(tuple);
-          } else {
-            c.addPermutation(tuple);
-            subsets.push_back(c);
-          }
+          addToCombo(subsets, index, new_combo, new_duplicates, tuple);
           tuple.pop_back();
           break;
         }
@@ -233,7 +210,8 @@ static void subsetSumWithDuplicates(const std::vector<Mask> &possible_lists,
       tuple.push_back(poss);
 
       subsetSumWithDuplicates(possible_lists, clashes, tuple, tuple_sum,
-                              subsets, target_sum, p + 1);
+                              new_combo, new_duplicates, subsets, index,
+                              target_sum, p + 1);
 
       tuple.pop_back();
       tuple_sum -= poss;
@@ -249,7 +227,179 @@ generateSubsetSumsWithDuplicates(const unsigned target_sum,
   std::vector<CageCombo> subsets;
   if (possibles.size() >= 32)
     throw invalid_grid_exception{"Too large a cage for the clash bitset"};
-  subsetSumWithDuplicates(possibles, clashes, tuple, 0, subsets, target_sum, 0);
+  ComboIndex index;
+  subsetSumWithDuplicates(possibles, clashes, tuple, 0, 0, 0, subsets, index,
+                          target_sum, 0);
+  return subsets;
+}
+
+// A group of a clashing cage's cells which can't see any cell outside of it,
+// and the ways of filling it in, by sum up to the cage's. Each way is a run of
+// values, one per cell of the group in order.
+struct ClashGroup {
+  std::vector<unsigned> cells;
+  std::vector<IntList> fills;
+  unsigned min_sum = 0, max_sum = 0;
+
+  std::size_t numFills(unsigned sum) const {
+    return fills[sum].size() / cells.size();
+  }
+};
+
+// Splits the cage's cells into groups which don't see each other, in order of
+// their first cell.
+static std::vector<ClashGroup>
+splitIntoClashGroups(const std::vector<Mask> &possibles,
+                     const std::vector<CellMask> &clashes) {
+  std::vector<ClashGroup> groups;
+  unsigned long ungrouped = (1ul << possibles.size()) - 1;
+  while (ungrouped) {
+    unsigned long group = ungrouped & -ungrouped, reached = group;
+    do {
+      group = reached;
+      for (unsigned long rest = group; rest; rest &= rest - 1)
+        reached |= clashes[__builtin_ctzl(rest)].to_ulong();
+    } while (reached != group);
+    ungrouped &= ~group;
+
+    ClashGroup &g = groups.emplace_back();
+    for (; group; group &= group - 1) {
+      const unsigned i = __builtin_ctzl(group);
+      g.cells.push_back(i);
+      g.min_sum += min_value(possibles[i]);
+      g.max_sum += max_value(possibles[i]);
+    }
+  }
+  return groups;
+}
+
+// Fills in the group's cells from 'pos' onwards, keeping the fills whose sum
+// lies within [lo, hi].
+static void fillClashGroup(ClashGroup &g, const std::vector<Mask> &possibles,
+                           const std::vector<CellMask> &clashes, IntList &fill,
+                           unsigned pos, unsigned sum, unsigned rest_min,
+                           unsigned rest_max, unsigned lo, unsigned hi) {
+  if (pos == g.cells.size()) {
+    g.fills[sum].insert(std::end(g.fills[sum]), std::begin(fill),
+                        std::end(fill));
+    return;
+  }
+  const unsigned cell = g.cells[pos];
+  const Mask m = possibles[cell];
+  rest_min -= min_value(m);
+  rest_max -= max_value(m);
+  for (unsigned i : m) {
+    const unsigned value = i + 1;
+    // Values are visited in order, so once too large, all the rest are.
+    if (sum + value + rest_min > hi)
+      break;
+    if (sum + value + rest_max < lo)
+      continue;
+    bool clash = false;
+    for (unsigned q = 0; q != pos && !clash; q++)
+      clash = fill[q] == value && clashes[cell][g.cells[q]];
+    if (clash)
+      continue;
+    fill[pos] = value;
+    fillClashGroup(g, possibles, clashes, fill, pos + 1, sum + value, rest_min,
+                   rest_max, lo, hi);
+  }
+}
+
+// Writes out every permutation combining a fill of each group from 'idx'
+// onwards which makes up 'remaining'.
+static void
+expandClashGroups(std::vector<ClashGroup> const &groups,
+                  std::vector<std::vector<uint64_t>> const &ways,
+                  std::size_t idx, unsigned remaining, IntList &tuple,
+                  std::vector<IntList> &tuples) {
+  if (idx == groups.size()) {
+    tuples.push_back(tuple);
+    return;
+  }
+  ClashGroup const &g = groups[idx];
+  const std::size_t n = g.cells.size();
+  for (unsigned sum = g.min_sum; sum <= std::min(g.max_sum, remaining); sum++) {
+    if (!ways[idx + 1][remaining - sum])
+      continue;
+    IntList const &fills = g.fills[sum];
+    for (std::size_t f = 0, e = fills.size(); f != e; f += n) {
+      for (std::size_t i = 0; i != n; i++)
+        tuple[g.cells[i]] = fills[f + i];
+      expandClashGroups(groups, ways, idx + 1, remaining - sum, tuple, tuples);
+    }
+  }
+}
+
+std::optional<std::vector<CageCombo>>
+generateClashingCageCombos(const unsigned target_sum,
+                           const std::vector<Mask> &possibles,
+                           const std::vector<CellMask> &clashes,
+                           const std::size_t max_permutations) {
+  std::vector<CageCombo> subsets;
+  if (possibles.size() >= 32)
+    throw invalid_grid_exception{"Too large a cage for the clash bitset"};
+  if (possibles.empty() || target_sum > 9 * possibles.size() ||
+      std::any_of(std::begin(possibles), std::end(possibles),
+                  [](Mask m) { return m.none(); }))
+    return subsets;
+
+  std::vector<ClashGroup> groups = splitIntoClashGroups(possibles, clashes);
+  unsigned all_min = 0, all_max = 0;
+  for (ClashGroup const &g : groups) {
+    all_min += g.min_sum;
+    all_max += g.max_sum;
+  }
+  if (target_sum < all_min || target_sum > all_max)
+    return subsets;
+
+  // Fill in each group on its own, bounded by what the other groups could
+  // possibly make up.
+  IntList fill;
+  for (ClashGroup &g : groups) {
+    const unsigned others_max = all_max - g.max_sum;
+    const unsigned lo = target_sum > others_max ? target_sum - others_max : 0;
+    const unsigned hi = target_sum - (all_min - g.min_sum);
+    g.fills.resize(target_sum + 1);
+    fill.assign(g.cells.size(), 0);
+    fillClashGroup(g, possibles, clashes, fill, 0, 0, g.min_sum, g.max_sum,
+                   lo, hi);
+  }
+
+  // ways[i][s] counts the ways groups i onwards can make up the sum s.
+  std::vector<std::vector<uint64_t>> ways(
+      groups.size() + 1, std::vector<uint64_t>(target_sum + 1, 0));
+  ways[groups.size()][0] = 1;
+  for (std::size_t i = groups.size(); i-- != 0;) {
+    ClashGroup const &g = groups[i];
+    for (unsigned sum = g.min_sum, e = std::min(g.max_sum, target_sum);
+         sum <= e; sum++) {
+      if (const std::size_t n = g.numFills(sum))
+        for (unsigned s = 0; s + sum <= target_sum; s++)
+          ways[i][s + sum] += n * ways[i + 1][s];
+    }
+  }
+
+  // Only now do we write out permutations, and only those that add up.
+  if (ways[0][target_sum] > max_permutations)
+    return std::nullopt;
+
+  std::vector<IntList> tuples;
+  tuples.reserve(ways[0][target_sum]);
+  IntList tuple(possibles.size());
+  expandClashGroups(groups, ways, 0, target_sum, tuple, tuples);
+  std::sort(std::begin(tuples), std::end(tuples));
+
+  ComboIndex combo_index;
+  for (IntList const &t : tuples) {
+    Mask combo = 0, duplicates = 0;
+    for (auto v : t) {
+      if (combo[v - 1])
+        duplicates.set(v - 1);
+      combo.set(v - 1);
+    }
+    addToCombo(subsets, combo_index, combo, duplicates, t);
+  }
   return subsets;
 }
 
@@ -262,8 +412,8 @@ static void expansionHelper(Cage const *cage, std::size_t idx, Mask m,
   // left to make up the combination.
   for (std::size_t ci = idx, ce = cage_size + 1 - m.count(); ci < ce; ++ci) {
     Cell const *cell = (*cage)[ci];
-    for (unsigned i = 0, e = m.size(); i != e; i++) {
-      if (!m[i] || !cell->candidates[i] || used.count(cell) != 0)
+    for (unsigned i : m & cell->candidates) {
+      if (used.count(cell) != 0)
         continue;
       combo.push_back(i + 1);
       if (combo.size() == cage_size) {
@@ -285,44 +435,151 @@ void expandComboPermutations(Cage const *cage, CageCombo &cage_combo) {
   expansionHelper(cage, 0u, cage_combo.combo, combo, used, cage_combo);
 }
 
-void CageCombo::erasePermutations(
-    std::function<bool(IntList const &)> const &pred) {
-  permutations.erase(
-      std::remove_if(std::begin(permutations), std::end(permutations), pred),
-      std::end(permutations));
+void PermutationList::push_back(Permutation perm) {
+  Rows &r = mutableRows();
+  if (r.values.empty())
+    r.stride = perm.size();
+  r.uses.clear();
+  const std::size_t row = numRows();
+  r.values.insert(std::end(r.values), perm.begin(), perm.end());
+  if (row % 64 == 0)
+    alive.push_back(0);
+  alive[row / 64] |= uint64_t(1) << (row % 64);
+  num_alive++;
+}
+
+void PermutationList::eraseByIndex(std::vector<std::size_t> const &indices) {
+  auto it = std::begin(indices);
+  std::size_t index = 0;
+  for (std::size_t row = nextRow(0), e = numRows();
+       row != e && it != std::end(indices); row = nextRow(row + 1), index++) {
+    if (index != *it)
+      continue;
+    kill(row);
+    ++it;
+  }
+  compactIfSparse();
 }
 
-void CageCombo::erasePermutationsByIndex(
-    std::vector<std::size_t> const &remove_indices) {
-  using size_type = decltype(permutations)::size_type;
-  auto vec_base = std::begin(permutations);
-  size_type down_by = 0;
-  for (auto it = remove_indices.cbegin(), ei = remove_indices.cend(); it != ei;
-       it++, down_by++) {
-    size_type next = (it + 1 == ei) ? permutations.size() : *(it + 1);
-    std::move(vec_base + *it + 1, vec_base + next, vec_base + *it - down_by);
+void PermutationList::eraseValue(std::size_t cell, unsigned value) {
+  if (num_alive == 0)
+    return;
+  std::vector<std::vector<uint64_t>> &uses = rows->uses;
+  if (uses.empty())
+    uses.resize(rows->stride * 9);
+  if (uses[cell * 9].empty()) {
+    for (unsigned v = 0; v < 9; v++)
+      uses[cell * 9 + v].assign(alive.size(), 0);
+    for (std::size_t row = 0, e = numRows(); row != e; row++)
+      uses[cell * 9 + getRow(row)[cell] - 1][row / 64] |= uint64_t(1)
+                                                          << (row % 64);
   }
-  permutations.resize(permutations.size() - remove_indices.size());
+
+  std::vector<uint64_t> const &used = uses[cell * 9 + value - 1];
+  num_alive = 0;
+  for (std::size_t w = 0, e = alive.size(); w != e; w++) {
+    alive[w] &= ~used[w];
+    num_alive += __builtin_popcountll(alive[w]);
+  }
+  compactIfSparse();
+}
+
+PermutationList::Rows &PermutationList::mutableRows() {
+  if (!rows)
+    rows = std::make_shared<Rows>();
+  else if (rows.use_count() > 1)
+    rows = std::make_shared<Rows>(*rows);
+  return *rows;
+}
+
+// Copies out the live rows once fewer than a quarter of them remain, so that
+// scans don't keep skipping over dead ones.
+void PermutationList::compactIfSparse() {
+  if (num_alive * 4 >= numRows())
+    return;
+  auto compacted = std::make_shared<Rows>();
+  compacted->stride = rows->stride;
+  compacted->values.reserve(num_alive * rows->stride);
+  for (Permutation perm : *this)
+    compacted->values.insert(std::end(compacted->values), perm.begin(),
+                             perm.end());
+  rows = std::move(compacted);
+  alive.assign((num_alive + 63) / 64, ~uint64_t(0));
+  if (num_alive % 64)
+    alive.back() = (uint64_t(1) << (num_alive % 64)) - 1;
+}
+
+bool CageCombo::restrictCell(std::size_t cell_idx, Mask values) {
+  const Mask removed = cell_values[cell_idx] & ~values;
+  if (removed.none())
+    return false;
+  const std::size_t prev_size = permutations.size();
+  cell_values[cell_idx] &= values;
+  for (unsigned i : removed)
+    permutations.eraseValue(cell_idx, i + 1);
+  return permutations.size() != prev_size;
 }
 
-void CageComboInfo::eraseCombos(
+bool CageComboInfo::eraseCombos(
     std::function<bool(CageCombo const &)> const &pred) {
+  // Check first, so that a no-op neither copies shared combos nor drops the
+  // cache.
+  if (std::none_of(combos->cbegin(), combos->cend(), pred))
+    return false;
+  ComboList &list = mutableCombos();
+  list.erase(std::remove_if(list.begin(), list.end(), pred), list.end());
   cached_killers.clear();
-  combos.erase(std::remove_if(begin(), end(), pred), end());
+  return true;
+}
+
+bool CageComboInfo::restrictCell(std::size_t cell_idx, Mask values) {
+  if (std::all_of(combos->cbegin(), combos->cend(),
+                  [cell_idx, values](CageCombo const &combo) {
+                    return combo.allowsAll(cell_idx, values);
+                  }))
+    return false;
+  bool changed = false;
+  for (CageCombo &combo : mutableCombos())
+    changed |= combo.restrictCell(cell_idx, values);
+  if (changed)
+    cached_killers.clear();
+  return changed;
 }
 
-std::unordered_set<Mask> CageComboInfo::getUniqueCombinations() const {
-  std::unordered_set<Mask> unique_combos;
+bool CageComboInfo::erasePermutationsByIndex(
+    std::size_t combo_idx, std::vector<std::size_t> const &indices) {
+  if (indices.empty())
+    return false;
+  mutableCombos()[combo_idx].erasePermutationsByIndex(indices);
+  cached_killers.clear();
+  return true;
+}
+
+CageComboInfo::ComboList &CageComboInfo::mutableCombos() {
+  if (combos.use_count() > 1)
+    combos = std::make_shared<ComboList>(*combos);
+  return *combos;
+}
+
+void CageComboInfo::restoreCombos(std::shared_ptr<ComboList> const &saved) {
+  if (combos == saved)
+    return;
+  combos = saved;
+  cached_killers.clear();
+}
+
+MaskSet CageComboInfo::getUniqueCombinations() const {
+  MaskSet unique_combos;
   for (CageCombo const &cage_combo : *this)
     unique_combos.insert(cage_combo.combo);
   return unique_combos;
 }
 
-std::unordered_set<Mask> CageComboInfo::getUniqueCombinationsWithMask(
+MaskSet CageComboInfo::getUniqueCombinationsWithMask(
     CellMask const &cage_cell_mask) const {
-  std::unordered_set<Mask> unique_combos;
+  MaskSet unique_combos;
 
-  for (auto const &cage_combo : *cage->cage_combos) {
+  for (auto const &cage_combo : *this) {
     for (auto const &perm : cage_combo.getPermutations()) {
       Mask m = 0;
       for (unsigned i = 0, e = perm.size(); i != e; i++)
@@ -334,8 +591,7 @@ std::unordered_set<Mask> CageComboInfo::getUniqueCombinationsWithMask(
   return unique_combos;
 }
 
-std::unordered_set<Mask>
-CageComboInfo::getUniqueCombinationsIn(House const &house) const {
+MaskSet CageComboInfo::getUniqueCombinationsIn(House const &house) const {
   // Fast path
   if (cage->areAllCellsAlignedWith(house))
     return getUniqueCombinations();
@@ -348,8 +604,7 @@ CageComboInfo::getUniqueCombinationsIn(House const &house) const {
   return getUniqueCombinationsWithMask(cell_mask);
 }
 
-std::unordered_set<Mask>
-CageComboInfo::getUniqueCombinationsWhichSee(Cell const *cell) const {
+MaskSet CageComboInfo::getUniqueCombinationsWhichSee(Cell const *cell) const {
   // Fast path
   if (std::all_of(std::begin(cage->cells), std::end(cage->cells),
                   [cell](const Cell *c) { return c->canSee(cell); }))
@@ -363,76 +618,46 @@ CageComboInfo::getUniqueCombinationsWhichSee(Cell const *cell) const {
   return getUniqueCombinationsWithMask(cage_cell_mask);
 }
 
-std::unordered_set<Mask>
-CageComboInfo::computeKillerPairs(unsigned max_size) {
+MaskSet CageComboInfo::computeKillerPairs(unsigned max_size) {
   CellMask cage_cell_mask;
   return computeKillerPairs(max_size, cage_cell_mask.set());
 }
 
-std::unordered_set<Mask>
-CageComboInfo::computeKillerPairs(unsigned max_size,
-                                  CellMask const &cell_mask) {
-  if (auto it = cached_killers.find({max_size, cell_mask.to_ulong()});
-      it != cached_killers.end())
-    return it->second;
-
-  std::unordered_set<Mask> oneofs;
+// The smallest sets of values which share at least one value with each of the
+// targets.
+static MaskSet minimalHittingSets(MaskSet const &targets) {
+  // Close the targets upwards: every mask containing one of them.
+  MaskSet containing = targets;
+  for (unsigned i = 0; i < 9; i++)
+    containing |= containing.withValueAdded(i);
+  // A mask misses a target only if its complement contains that target.
+  MaskSet hitting = ~containing.complements();
+  // Hitting sets stay hitting sets with values added, so the minimal ones are
+  // those which aren't one of them plus a value.
+  MaskSet minimal = hitting;
+  for (unsigned i = 0; i < 9; i++)
+    minimal &= ~hitting.withValueAdded(i);
+  return minimal;
+}
 
-  if (cage->size() == 2 || cage->size() == 3 || cage->size() == 4) {
-    bool size1 = size() < 2;
-    bool size2 = size() < 3;
-    bool size3 = size() < 4;
-    for (unsigned i = 0; i < 9; i++) {
-      if (!combos[0].combo[i])
-        continue;
-      for (unsigned j = size1 ? i : 0; j < (size1 ? i + 1 : 9); j++) {
-        if (!size1 && !combos[1].combo[j])
-          continue;
-        Mask oneof(1 << i | 1 << j);
-        for (unsigned k = size2 ? j : 0; k < (size2 ? j + 1 : 9); k++) {
-          if (!size2 && !combos[2].combo[k])
-            continue;
-          Mask oneof(1 << i | 1 << j | 1 << k);
-          if (oneof.count() > max_size)
-            continue;
-          for (unsigned l = size3 ? k : 0; l < (size3 ? k + 1 : 9); l++) {
-            if (!size3 && !combos[3].combo[l])
-              continue;
-            Mask oneof(1 << i | 1 << j | 1 << k | 1 << l);
-            if (oneof.count() > max_size)
-              continue;
-            if (cell_mask.all()) {
-              if (std::all_of(begin(), end(), [oneof](CageCombo const &cc) {
-                    return (cc.combo & oneof).any();
-                  }))
-                oneofs.insert(oneof);
-            } else {
-              // Only return "oneof"s in the cells that we're interested in.
-              // This may produce a more restricted subset.
-              if (std::all_of(
-                      begin(), end(), [oneof, &cell_mask](CageCombo const &cc) {
-                        return std::all_of(
-                            std::begin(cc.getPermutations()),
-                            std::end(cc.getPermutations()),
-                            [&oneof, &cell_mask](auto const &perm) {
-                              Mask m = 0;
-                              for (unsigned i = 0, e = perm.size(); i != e; i++)
-                                m |= (cell_mask[i] ? 1 : 0) << (perm[i] - 1);
-                              return (m & oneof).any();
-                            });
-                      })) {
-                oneofs.insert(oneof);
-              }
-            }
-          }
-        }
-      }
-    }
+MaskSet CageComboInfo::computeKillerPairs(unsigned max_size,
+                                          CellMask const &cell_mask) {
+  auto [it, inserted] = cached_killers.try_emplace(cell_mask.to_ulong());
+  if (inserted) {
+    // Only return "oneof"s in the cells that we're interested in. This may
+    // produce a more restricted subset.
+    MaskSet targets = cell_mask.all()
+                          ? getUniqueCombinations()
+                          : getUniqueCombinationsWithMask(cell_mask);
+    // A cage without combos can't be satisfied, and other steps will say so.
+    if (targets.any())
+      it->second = minimalHittingSets(targets);
   }
 
-  // Cache these results for later.
-  cached_killers[{max_size, cell_mask.to_ulong()}] = oneofs;
-
+  MaskSet oneofs;
+  for (Mask m : it->second)
+    if (m.count() <= max_size)
+      oneofs.insert(m);
   return oneofs;
 }
 
@@ -466,9 +691,13 @@ bool reduceBasedOnCageRelations(Cage &lhs, Cage &rhs, int sum, CellSet &changed,
        to_check) {
     if (cage.size() == 1 && signof(diff) == sign_val) {
       Cell *cell = cage[0];
+      const int largest = max - std::abs(diff);
+      if (largest <= 0)
+        throw invalid_grid_exception{
+            "Stripping would invalidate all candidates"};
       Mask stripped_mask = 0;
       for (size_t e = cell->candidates.size(),
-                  j = static_cast<size_t>(max - std::abs(diff));
+                  j = static_cast<size_t>(largest);
            j != e; j++)
         stripped_mask.set(j);
       if (auto intersection = ColumboStep::updateCell(
@@ -502,7 +731,8 @@ bool reduceBasedOnCageRelations(Cage &lhs, Cage &rhs, int sum, CellSet &changed,
           continue;
         // Calculate the strip mask for this cell.
         Mask stripped_mask = 0;
-        for (size_t j = 0, e = static_cast<size_t>(min_diff); j != e; j++)
+        for (size_t j = 0, e = static_cast<size_t>(std::min(min_diff, 9));
+             j != e; j++)
           stripped_mask.set(j);
         // Double-check we're not invalidating this cell
         if (stripped_mask.all())
@@ -526,12 +756,12 @@ bool reduceBasedOnCageRelations(Cage &lhs, Cage &rhs, int sum, CellSet &changed,
   return modified;
 }
 
-Mask CageCombo::comboMaskFromPermuation(IntList const &permutation) {
+Mask CageCombo::comboMaskFromPermuation(Permutation permutation) {
   CellMask m;
   return CageCombo::comboMaskFromPermuation(permutation, m.set());
 }
 
-Mask CageCombo::comboMaskFromPermuation(IntList const &permutation,
+Mask CageCombo::comboMaskFromPermuation(Permutation permutation,
                                         CellMask cell_mask) {
   Mask combo_mask = 0;
   for (unsigned i = 0, e = permutation.size(); i != e; i++)
@@ -2,6 +2,7 @@
 #define COLUMBO_COMBINATIONS_H
 
 #include "defs.h"
+#include <optional>
 #include <vector>
 
 std::vector<CageCombo>
@@ -9,13 +10,23 @@ generateCageSubsetSums(const unsigned target_sum,
                        const std::vector<Mask> &possibles);
 
 
-std::unique_ptr<CageComboInfo> generateCageComboInfo(Cage const *cage);
+ArenaPtr<CageComboInfo> generateCageComboInfo(Arena &arena, Cage const *cage);
 
 std::vector<CageCombo>
 generateSubsetSumsWithDuplicates(const unsigned target_sum,
                                  const std::vector<Mask> &possibles,
                                  const std::vector<CellMask> &clashes);
 
+// As above, but splits the cage into groups of cells which don't see each
+// other and combines the sums each group can make, so that permutations are
+// only written out once they're known to make up the target sum. Gives up if
+// there would be more than max_permutations of them.
+std::optional<std::vector<CageCombo>>
+generateClashingCageCombos(const unsigned target_sum,
+                           const std::vector<Mask> &possibles,
+                           const std::vector<CellMask> &clashes,
+                           const std::size_t max_permutations);
+
 void expandComboPermutations(Cage const *cage, CageCombo &cage_combo);
 
 bool reduceBasedOnCageRelations(Cage &lhs, Cage &rhs, int sum, CellSet &changed,
@@ -11,13 +11,11 @@
 //extern bool DEBUG;
 
 static inline std::string printCandidateString(Mask mask) {
-  std::stringstream ss;
-  for (unsigned i = 0; i < 9; ++i) {
-    if (mask[i]) {
-      ss << (i + 1) << '/';
-    }
+  std::string s;
+  for (unsigned i : mask) {
+    s += static_cast<char>('1' + i);
+    s += '/';
   }
-  std::string s = ss.str();
   // Remove the trailing '/'
   return s.substr(0, s.size() - 1);
 }
@@ -26,17 +24,10 @@ static inline std::ostream &dbgs() { return std::cerr; }
 
 static inline std::string printCellMask(House &house, const Mask mask) {
   std::stringstream ss;
-  std::size_t found = 0;
-  const std::size_t bit_count = mask.count();
-  for (unsigned i = 0; i < 9; ++i) {
-    if (!mask[i]) {
-      continue;
-    }
-    ++found;
-    ss << house[i]->coord;
-    if (found < bit_count) {
-      ss << "/";
-    }
+  bool sep = false;
+  for (unsigned i : mask) {
+    ss << (sep ? "/" : "") << house[i]->coord;
+    sep = true;
   }
   return ss.str();
 }
@@ -2,43 +2,10 @@
 #include "init.h"
 #include "combinations.h"
 
+#include <cassert>
 #include <set>
 #include <iomanip>
 
-unsigned max_value(Mask m) {
-  assert(m.any() && "Unset mask");
-  for (int i = static_cast<int>(m.size()) - 1; i >= 0; --i) {
-    if (m[static_cast<unsigned>(i)])
-      return static_cast<unsigned>(i + 1);
-  }
-  return 0;
-}
-
-unsigned min_value(Mask m) {
-  assert(m.any() && "Unset mask");
-  for (unsigned i = 0, e = m.size(); i != e; ++i) {
-    if (m[static_cast<unsigned>(i)])
-      return static_cast<unsigned>(i + 1);
-  }
-  return 0;
-}
-
-std::vector<Cage *> Cell::all_cages() {
-  std::vector<Cage *> cages{cage};
-  cages.insert(std::end(cages), std::begin(pseudo_cages),
-               std::end(pseudo_cages));
-  return cages;
-}
-
-std::vector<Cage const *> Cell::all_cages() const {
-  std::vector<Cage const *> cages{cage};
-  cages.insert(std::end(cages), std::begin(pseudo_cages),
-               std::end(pseudo_cages));
-  return cages;
-}
-
-House::~House() {}
-
 bool House::contains(Cell const *cell) const {
   return cell->box == this || cell->row == this || cell->col == this;
 }
@@ -55,18 +22,6 @@ std::ostream &operator<<(std::ostream &os, House const &house) {
   return os;
 }
 
-unsigned Row::getLinearID(const Cell *const cell) const {
-  return cell->coord.col;
-}
-
-unsigned Col::getLinearID(const Cell *const cell) const {
-  return cell->coord.row;
-}
-
-unsigned Box::getLinearID(const Cell *const cell) const {
-  return (cell->coord.col % 3) + (3 * (cell->coord.row % 3));
-}
-
 void InnieOutieRegion::initialize(Grid *const grid) {
   std::set<Cage *> visited_cages;
   for (unsigned row = min.row; row <= max.row; ++row) {
@@ -82,16 +37,16 @@ void InnieOutieRegion::initialize(Grid *const grid) {
         const Coord &coord = cage_cell->coord;
         if (coord.row >= min.row && coord.row <= max.row &&
             coord.col >= min.col && coord.col <= max.col) {
-          innie_outie->inside_cage->cells.push_back(cage_cell);
+          innie_outie->inside_cage->cells.addCell(cage_cell);
         } else {
-          innie_outie->outside_cage->cells.push_back(cage_cell);
+          innie_outie->outside_cage->cells.addCell(cage_cell);
         }
       }
 
       if (innie_outie->inside_cage->size() == cage->size()) {
         // Add to the known total if all cells are inside
         for (auto *innie_cell : *innie_outie->inside_cage)
-          known_cage->cells.push_back(innie_cell);
+          known_cage->cells.addCell(innie_cell);
         known_cage->sum += cage->sum;
         continue;
       }
@@ -101,13 +56,108 @@ void InnieOutieRegion::initialize(Grid *const grid) {
   }
 }
 
+static void holdPseudoCage(Cage *cage) {
+  if (cage->num_regions++)
+    return;
+  for (auto *c : *cage)
+    c->pseudo_cages.push_back(cage);
+}
+
+static void releasePseudoCage(Cage *cage) {
+  assert(cage->num_regions && "Pseudo cage isn't held");
+  if (--cage->num_regions)
+    return;
+  for (auto *c : *cage) {
+    auto &cell_cages = c->pseudo_cages;
+    cell_cages.erase(
+        std::find(std::begin(cell_cages), std::end(cell_cages), cage));
+  }
+}
+
+void InnieOutieRegion::addPseudoCage(std::vector<Cage *> &list, Cage *cage) {
+  list.push_back(cage);
+  if (active)
+    holdPseudoCage(cage);
+}
+
+void InnieOutieRegion::setPseudoCagesAttached(bool attach) {
+  for (auto *list : {&innies, &large_innies, &large_outies})
+    for (Cage *cage : *list)
+      attach ? holdPseudoCage(cage) : releasePseudoCage(cage);
+}
+
+void InnieOutieRegion::retire() {
+  active = false;
+  setPseudoCagesAttached(false);
+}
+
+InnieOutieRegion::State InnieOutieRegion::saveState() const {
+  State state;
+  state.active = active;
+  state.known_sum = known_cage->sum;
+  state.known_cells = known_cage->cells;
+  state.innies_outies.reserve(innies_outies.size());
+  for (auto const &io : innies_outies)
+    state.innies_outies.push_back(
+        {io->sum, io->inside_cage->cells, io->outside_cage->cells});
+  state.num_innies = innies.size();
+  state.num_large_innies = large_innies.size();
+  state.num_large_outies = large_outies.size();
+  return state;
+}
+
+void InnieOutieRegion::restoreState(State const &state) {
+  known_cage->sum = state.known_sum;
+  known_cage->cells = state.known_cells;
+
+  innies_outies.clear();
+  for (auto const &io_state : state.innies_outies) {
+    auto io = std::make_unique<InnieOutie>(io_state.sum);
+    io->inside_cage->cells = io_state.inside_cells;
+    io->outside_cage->cells = io_state.outside_cells;
+    innies_outies.push_back(std::move(io));
+  }
+
+  // Pseudo cages are only ever appended, so dropping the newer ones restores
+  // the lists.
+  for (auto [list, size] : {std::pair{&innies, state.num_innies},
+                            std::pair{&large_innies, state.num_large_innies},
+                            std::pair{&large_outies, state.num_large_outies}}) {
+    if (active)
+      std::for_each(std::begin(*list) + size, std::end(*list),
+                    releasePseudoCage);
+    list->resize(size);
+  }
+
+  if (active != state.active) {
+    active = state.active;
+    setPseudoCagesAttached(active);
+  }
+}
+
+Grid::~Grid() {
+  // Detach the pseudo cages up front, rather than have each one search its
+  // cells' lists as it's destroyed.
+  for (auto &row : cells)
+    for (Cell &cell : row)
+      cell.pseudo_cages.clear();
+}
+
 Cell *Grid::getCell(const Coord &coord) {
   return getCell(coord.row, coord.col);
 }
 
 Cell *Grid::getCell(unsigned y, unsigned x) { return &(cells[y][x]); }
 
-bool Grid::initialize(std::ifstream &file, bool v) {
+House *Grid::getHouse(unsigned idx) {
+  if (idx < 9)
+    return rows[idx].get();
+  if (idx < 18)
+    return cols[idx - 9].get();
+  return boxes[idx - 18].get();
+}
+
+bool Grid::initialize(std::istream &file, bool v) {
   if (initializeGridFromFile(file, this))
     return true;
   if (initializeCages())
@@ -237,9 +287,95 @@ void Grid::writeToFile(std::ostream &file) {
   file.flush();
 }
 
+GridSnapshot Grid::snapshot() const {
+  GridSnapshot snap;
+  snap.candidates = candidates;
+  snap.cage_combos.reserve(cage_combos.size());
+  for (auto const &info : cage_combos)
+    snap.cage_combos.push_back(info->shareCombos());
+  snap.num_pseudo_cages = pseudo_cages.size();
+  snap.arena_mark = arena.mark();
+  snap.regions.reserve(innies_and_outies.size());
+  for (auto const &region : innies_and_outies)
+    snap.regions.push_back(region->saveState());
+  for (unsigned i = 0; i < 9; i++) {
+    snap.house_regions[rowHouseIndex(i)] = rows[i]->region;
+    snap.house_regions[colHouseIndex(i)] = cols[i]->region;
+    snap.house_regions[boxHouseIndex(i)] = boxes[i]->region;
+  }
+  return snap;
+}
+
+void Grid::restore(GridSnapshot const &snap) {
+  assert(snap.regions.size() == innies_and_outies.size() &&
+         "Snapshot from a different grid");
+  assert(snap.cage_combos.size() <= cage_combos.size() &&
+         "Snapshot was taken after the grid's current state");
+  candidates = snap.candidates;
+
+  for (unsigned i = 0, e = innies_and_outies.size(); i != e; i++)
+    innies_and_outies[i]->restoreState(snap.regions[i]);
+  // The regions no longer use the pseudo cages created since, so they can go.
+  for (std::size_t i = snap.num_pseudo_cages, e = pseudo_cages.size(); i != e;
+       i++)
+    pseudo_cage_index.erase(pseudo_cages[i]->getPseudoCageKey());
+  pseudo_cages.resize(snap.num_pseudo_cages);
+
+  cage_combos.resize(snap.cage_combos.size());
+  for (unsigned i = 0, e = cage_combos.size(); i != e; i++)
+    cage_combos[i]->restoreCombos(snap.cage_combos[i]);
+
+  for (unsigned i = 0; i < NumHouses; i++)
+    getHouse(i)->region = snap.house_regions[i];
+
+  // Restoring brings back permutations, which permutation counts can't tell
+  // apart from losing others, so treat every cage as changed.
+  seen_cage_combos.clear();
+
+  // Everything allocated since the snapshot has now been dropped.
+  arena.rewind(snap.arena_mark);
+}
+
+void Grid::updateGenerations() {
+  HouseMask cell_houses, cage_houses;
+  CellSet changed;
+  for (unsigned i = 0; i < NumCells; i++)
+    if (candidates[i] != seen_candidates[i])
+      changed.insert(i);
+  seen_candidates = candidates;
+  if (changed.any())
+    for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++)
+      cell_houses[house_idx] = (changed & HouseCellSets[house_idx]).any();
+
+  // Between restores, cages only ever lose permutations, so an unchanged
+  // count means unchanged combos.
+  for (std::size_t k = 0, e = cage_combos.size(); k != e; k++) {
+    std::size_t count = 0;
+    for (CageCombo const &combo : cage_combos[k]->getCombos())
+      count += combo.getPermutations().size();
+    if (k < seen_cage_combos.size()) {
+      if (count != seen_cage_combos[k].first)
+        cage_houses |= seen_cage_combos[k].second;
+      seen_cage_combos[k].first = count;
+      continue;
+    }
+    HouseMask houses;
+    for (Cell const *cell : *cage_combos[k]->cage)
+      for (unsigned house_idx : CellHouses[cell->getIndex()])
+        houses.set(house_idx);
+    seen_cage_combos.emplace_back(count, houses);
+    cage_houses |= houses;
+  }
+
+  for (unsigned i = 0; i < NumHouses; i++) {
+    cell_generations[i] += cell_houses[i];
+    cage_generations[i] += cage_houses[i];
+  }
+}
+
 void Grid::initializeCageSubsetMap() {
   for (auto &cage : cages) {
-    cage_combos.emplace_back(generateCageComboInfo(cage.get()));
+    cage_combos.emplace_back(generateCageComboInfo(arena, cage.get()));
     cage->cage_combos = cage_combos.back().get();
   }
 }
@@ -249,8 +385,8 @@ void Grid::initializeInnieAndOutieRegions() {
   const int max_width = 4;
   for (unsigned width = 1; width <= max_width; ++width) {
     for (unsigned col = 0; col <= 9 - width; ++col) {
-      auto region = std::make_unique<InnieOutieRegion>(
-          Coord{0, col}, Coord{8, col + width - 1});
+      auto region = arena.make<InnieOutieRegion>(
+          arena, Coord{0, col}, Coord{8, col + width - 1});
       region->initialize(this);
       if (region->known_cage->sum != region->expected_sum) {
         innies_and_outies.push_back(std::move(region));
@@ -265,8 +401,8 @@ void Grid::initializeInnieAndOutieRegions() {
   // Do row-oriented regions
   for (unsigned width = 1; width <= max_width; ++width) {
     for (unsigned row = 0; row <= 9 - width; ++row) {
-      auto region = std::make_unique<InnieOutieRegion>(
-          Coord{row, 0}, Coord{row + width - 1, 8});
+      auto region = arena.make<InnieOutieRegion>(
+          arena, Coord{row, 0}, Coord{row + width - 1, 8});
       region->initialize(this);
       if (region->known_cage->sum != region->expected_sum) {
         innies_and_outies.push_back(std::move(region));
@@ -282,8 +418,8 @@ void Grid::initializeInnieAndOutieRegions() {
     for (unsigned y = 0; y <= 3 - ywidth; ++y) {
       for (unsigned xwidth = 1; xwidth <= 2; ++xwidth) {
         for (unsigned x = 0; x <= 3 - xwidth; ++x) {
-          auto region = std::make_unique<InnieOutieRegion>(
-              Coord{y * 3, x * 3},
+          auto region = arena.make<InnieOutieRegion>(
+              arena, Coord{y * 3, x * 3},
               Coord{y * 3 + (3 * ywidth) - 1, x * 3 + (3 * xwidth) - 1});
           region->initialize(this);
           if (region->known_cage->sum != region->expected_sum) {
@@ -1,23 +1,31 @@
 #ifndef COLUMBO_DEFS_H
 #define COLUMBO_DEFS_H
 
+#include "arena.h"
+#include "cell_set.h"
+#include "grid_tables.h"
+#include "mask.h"
+#include "mask_set.h"
 #include "printable.h"
+#include "small_vector.h"
 #include <algorithm>
 #include <array>
 #include <bitset>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <sstream>
+#include <utility>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
-using Mask = std::bitset<9>;
+using CandidateSet = Mask;
 
-unsigned max_value(Mask m);
-unsigned min_value(Mask m) ;
-
-using CandidateSet = std::bitset<9>;
+// A set of the grid's houses, by house index.
+using HouseMask = std::bitset<NumHouses>;
 
 // A mask that has one index dedicated to each cell in a given cage. If any
 // cage is larger than 32 cells, this can change.
@@ -25,64 +33,218 @@ using CellMask = std::bitset<32>;
 
 using IntList = std::vector<uint8_t>;
 
+// A view of one permutation of a cage: the value of each cage cell in turn.
+struct Permutation {
+  Permutation(uint8_t const *values, std::size_t length)
+      : values(values), length(length) {}
+  Permutation(IntList const &list) : values(list.data()), length(list.size()) {}
+
+  std::size_t size() const { return length; }
+  uint8_t operator[](std::size_t i) const { return values[i]; }
+
+  uint8_t const *begin() const { return values; }
+  uint8_t const *end() const { return values + length; }
+
+private:
+  uint8_t const *values;
+  std::size_t length;
+};
+
+// Permutations stored back to back in one flat array, one row of 'stride'
+// values per permutation. Cages can have thousands of permutations, so this
+// avoids a heap allocation for each of them. Erasing a permutation only clears
+// its bit in a bitset of live rows. The rows themselves are shared between
+// copies, such as grid snapshots, and are compacted once most of them are
+// dead.
+class PermutationList {
+public:
+  // Iterates over the live rows.
+  class const_iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Permutation;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Permutation;
+
+    const_iterator(PermutationList const *list, std::size_t row)
+        : list(list), row(row) {}
+
+    Permutation operator*() const { return list->getRow(row); }
+    const_iterator &operator++() {
+      row = list->nextRow(row + 1);
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator it = *this;
+      ++*this;
+      return it;
+    }
+    bool operator==(const_iterator const &other) const {
+      return row == other.row;
+    }
+    bool operator!=(const_iterator const &other) const {
+      return row != other.row;
+    }
+
+  private:
+    PermutationList const *list;
+    std::size_t row;
+  };
+
+  std::size_t size() const { return num_alive; }
+  bool empty() const { return num_alive == 0; }
+
+  const_iterator begin() const { return {this, nextRow(0)}; }
+  const_iterator end() const { return {this, numRows()}; }
+
+  void push_back(Permutation perm);
+
+  // Removes the permutations matching pred.
+  template <typename Pred> void eraseIf(Pred pred) {
+    for (std::size_t row = nextRow(0), e = numRows(); row != e;
+         row = nextRow(row + 1))
+      if (pred(getRow(row)))
+        kill(row);
+    compactIfSparse();
+  }
+
+  // Removes the permutations at the given ascending indices, counting in
+  // iteration order.
+  void eraseByIndex(std::vector<std::size_t> const &indices);
+
+  // Removes the permutations which put the given value in the given cell.
+  void eraseValue(std::size_t cell, unsigned value);
+
+private:
+  struct Rows {
+    std::vector<uint8_t> values;
+    std::size_t stride = 0;
+    // For each cell and value, a bitset of the rows which put that value in
+    // that cell, indexed by cell * 9 + value - 1. Each cell's bitsets are
+    // built the first time a value is erased from it.
+    std::vector<std::vector<uint64_t>> uses;
+  };
+
+  std::shared_ptr<Rows> rows;
+  std::vector<uint64_t> alive;
+  std::size_t num_alive = 0;
+
+  std::size_t numRows() const {
+    return rows ? rows->values.size() / rows->stride : 0;
+  }
+  Permutation getRow(std::size_t row) const {
+    return {rows->values.data() + row * rows->stride, rows->stride};
+  }
+
+  // Returns the first live row at or after 'row', or numRows() if none.
+  std::size_t nextRow(std::size_t row) const {
+    std::size_t word = row / 64;
+    if (word >= alive.size())
+      return numRows();
+    uint64_t bits = alive[word] & (~uint64_t(0) << (row % 64));
+    while (!bits) {
+      if (++word == alive.size())
+        return numRows();
+      bits = alive[word];
+    }
+    return word * 64 + __builtin_ctzll(bits);
+  }
+
+  void kill(std::size_t row) {
+    alive[row / 64] &= ~(uint64_t(1) << (row % 64));
+    num_alive--;
+  }
+
+  Rows &mutableRows();
+  void compactIfSparse();
+};
+
 struct CageCombo {
-  explicit CageCombo(Mask m) : combo(m) {}
+  explicit CageCombo(Mask m) : combo(m) { cell_values.fill(m); }
   Mask combo;
   Mask duplicates = 0;
 
-  static Mask comboMaskFromPermuation(IntList const &permutation);
-  static Mask comboMaskFromPermuation(IntList const &permutation, CellMask m);
+  static Mask comboMaskFromPermuation(Permutation permutation);
+  static Mask comboMaskFromPermuation(Permutation permutation, CellMask m);
 
-  std::vector<IntList> const &getPermutations() const { return permutations; }
-  void addPermutation(IntList const &perm) { permutations.push_back(perm); }
+  PermutationList const &getPermutations() const { return permutations; }
+  void addPermutation(Permutation perm) { permutations.push_back(perm); }
 
-  void erasePermutations(std::function<bool(IntList const &)> const &pred);
-  void erasePermutationsByIndex(std::vector<std::size_t> const &indices);
+  template <typename Pred> void erasePermutations(Pred pred) {
+    permutations.eraseIf(pred);
+  }
+  void erasePermutationsByIndex(std::vector<std::size_t> const &indices) {
+    permutations.eraseByIndex(indices);
+  }
+
+  // Whether restricting the given cell to 'values' would be a no-op.
+  bool allowsAll(std::size_t cell_idx, Mask values) const {
+    return (cell_values[cell_idx] & ~values).none();
+  }
+  // Removes the permutations which put a value outside of 'values' in the
+  // given cell. Only values not already removed from the cell cost anything.
+  // Returns whether any permutations were removed.
+  bool restrictCell(std::size_t cell_idx, Mask values);
 
 private:
-  std::vector<IntList> permutations = {};
+  PermutationList permutations;
+  // For each cell, the values which haven't been removed from it. The
+  // permutations may still use fewer.
+  std::array<Mask, 32> cell_values;
 };
 
 struct Cell;
 struct Cage;
 struct House;
+struct ColumboStep;
 
 struct CageComboInfo {
-  CageComboInfo(Cage const *cage, std::vector<CageCombo> &&combos)
-      : cage(cage), combos(combos) {}
+  using ComboList = std::vector<CageCombo>;
 
-  std::size_t size() const { return combos.size(); }
+  CageComboInfo(Cage const *cage, ComboList &&combos)
+      : cage(cage), combos(std::make_shared<ComboList>(std::move(combos))) {}
 
-  std::vector<CageCombo>::iterator end() { return combos.end(); }
-  std::vector<CageCombo>::iterator begin() { return combos.begin(); }
+  std::size_t size() const { return combos->size(); }
 
-  std::vector<CageCombo>::const_iterator end() const { return combos.end(); }
-  std::vector<CageCombo>::const_iterator begin() const {
-    return combos.begin();
-  }
+  ComboList::iterator end() { return mutableCombos().end(); }
+  ComboList::iterator begin() { return mutableCombos().begin(); }
+
+  ComboList::const_iterator end() const { return combos->cend(); }
+  ComboList::const_iterator begin() const { return combos->cbegin(); }
+
+  MaskSet computeKillerPairs(unsigned max_size);
+  MaskSet computeKillerPairs(unsigned max_size, CellMask const &cell_mask);
+  // The number of cell masks whose killers are cached.
+  std::size_t getNumCachedKillers() const { return cached_killers.size(); }
+  MaskSet getUniqueCombinations() const;
+  MaskSet getUniqueCombinationsIn(House const &house) const;
+  MaskSet getUniqueCombinationsWhichSee(Cell const *cell) const;
 
-  std::unordered_set<Mask> computeKillerPairs(unsigned max_size);
-  std::unordered_set<Mask>
-  computeKillerPairs(unsigned max_size, CellMask const &cell_mask);
-  std::unordered_set<Mask> getUniqueCombinations() const;
-  std::unordered_set<Mask> getUniqueCombinationsIn(House const &house) const;
-  std::unordered_set<Mask>
-  getUniqueCombinationsWhichSee(Cell const *cell) const;
+  ComboList const &getCombos() const { return *combos; }
 
-  std::vector<CageCombo> const &getCombos() const { return combos; }
+  // These return whether any combos or permutations were removed. Only such
+  // a change throws away the cached killers.
+  bool eraseCombos(std::function<bool(CageCombo const &)> const &fn);
+  bool restrictCell(std::size_t cell_idx, Mask values);
+  bool erasePermutationsByIndex(std::size_t combo_idx,
+                                std::vector<std::size_t> const &indices);
 
-  void eraseCombos(std::function<bool(CageCombo const &)> const &fn);
+  // The combos are copy-on-write: a snapshot shares them with this cage until
+  // either side is modified.
+  std::shared_ptr<ComboList> shareCombos() const { return combos; }
+  void restoreCombos(std::shared_ptr<ComboList> const &saved);
 
   Cage const *cage;
 private:
-  std::vector<CageCombo> combos;
+  std::shared_ptr<ComboList> combos;
 
-  // Caching from max size & CellMask to computed killers.
-  std::map<std::pair<unsigned, unsigned long>, std::unordered_set<Mask>>
-      cached_killers;
+  ComboList &mutableCombos();
 
-  std::unordered_set<Mask>
-  getUniqueCombinationsWithMask(CellMask const &cage_cell_mask) const;
+  // Caching from CellMask to computed killers of any size.
+  std::map<unsigned long, MaskSet> cached_killers;
+
+  MaskSet getUniqueCombinationsWithMask(CellMask const &cage_cell_mask) const;
 };
 
 struct Coord {
@@ -95,20 +257,81 @@ struct Coord {
 
 std::ostream &operator<<(std::ostream &os, const Coord &coord);
 
-using CageList = std::vector<std::unique_ptr<Cage>>;
+using CageList = std::vector<ArenaPtr<Cage>>;
+
+// A view of the cages a cell is in: its real cage, then its pseudo cages.
+template <typename CagePtr> class CellCageRange {
+public:
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = CagePtr;
+    using difference_type = std::ptrdiff_t;
+    using pointer = CagePtr const *;
+    using reference = CagePtr;
+
+    iterator(CagePtr cage, CagePtr const *pseudo_cages, std::size_t idx)
+        : cage(cage), pseudo_cages(pseudo_cages), idx(idx) {}
+
+    CagePtr operator*() const { return idx ? pseudo_cages[idx - 1] : cage; }
+    iterator &operator++() {
+      idx++;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator it = *this;
+      idx++;
+      return it;
+    }
+    bool operator==(iterator const &other) const { return idx == other.idx; }
+    bool operator!=(iterator const &other) const { return idx != other.idx; }
+
+  private:
+    CagePtr cage;
+    CagePtr const *pseudo_cages;
+    std::size_t idx;
+  };
+
+  CellCageRange(CagePtr cage, CagePtr const *pseudo_cages,
+                std::size_t num_pseudo_cages)
+      : cage(cage), pseudo_cages(pseudo_cages),
+        num_pseudo_cages(num_pseudo_cages) {}
+
+  iterator begin() const { return iterator{cage, pseudo_cages, 0}; }
+  iterator end() const {
+    return iterator{cage, pseudo_cages, num_pseudo_cages + 1};
+  }
+  std::size_t size() const { return num_pseudo_cages + 1; }
+
+private:
+  CagePtr cage;
+  CagePtr const *pseudo_cages;
+  std::size_t num_pseudo_cages;
+};
 
 struct Cell {
-  Cage *cage;
+  Cage *cage = nullptr;
   Coord coord;
-  CandidateSet candidates;
-  std::vector<Cage *> pseudo_cages;
-  Cell() : cage(nullptr), candidates() {
-    /* Set all candidates by default */
-    candidates.set();
-  }
+  // This cell's entry in its grid's candidate array.
+  CandidateSet &candidates;
+  // Cells are rarely in more than a few pseudo cages at once; the rest spill
+  // to the heap.
+  SmallVector<Cage *, 4> pseudo_cages;
+
+  Cell(CandidateSet &candidates, Coord coord)
+      : coord(coord), candidates(candidates) {}
+
+  Cell(Cell &&) = delete;
+  Cell(Cell const &) = delete;
 
-  std::vector<Cage *> all_cages();
-  std::vector<Cage const *> all_cages() const;
+  unsigned getIndex() const { return cellIndex(coord.row, coord.col); }
+
+  CellCageRange<Cage *> all_cages() {
+    return {cage, pseudo_cages.data(), pseudo_cages.size()};
+  }
+  CellCageRange<Cage const *> all_cages() const {
+    return {cage, pseudo_cages.data(), pseudo_cages.size()};
+  }
 
   const House *row = nullptr;
   const House *col = nullptr;
@@ -120,21 +343,12 @@ struct Cell {
   }
 
   unsigned isFixed() const {
-    if (candidates.count() != 1) {
-      return 0;
-    }
-    for (unsigned i = 0; i < 9; ++i) {
-      if (candidates[i]) {
-        return i + 1;
-      }
-    }
-    return 0;
+    return candidates.hasSingleBit() ? candidates.first() + 1 : 0;
   }
 };
 
-using CellSet = std::set<Cell *>;
-
 struct InnieOutieRegion;
+struct GridSnapshot;
 
 enum class HouseKind { Row, Col, Box };
 
@@ -148,9 +362,23 @@ struct House {
   House(House &&) = delete;
   House(House const &) = delete;
 
-  virtual ~House();
+  // The index of this house in the grid's house tables.
+  unsigned getIndex() const {
+    if (kind == HouseKind::Row)
+      return rowHouseIndex(num);
+    if (kind == HouseKind::Col)
+      return colHouseIndex(num);
+    return boxHouseIndex(num);
+  }
 
-  virtual unsigned getLinearID(const Cell *const) const { return 0; }
+  // The position of the given cell within this house.
+  unsigned getLinearID(const Cell *const cell) const {
+    if (kind == HouseKind::Row)
+      return cell->coord.col;
+    if (kind == HouseKind::Col)
+      return cell->coord.row;
+    return (cell->coord.col % 3) + (3 * (cell->coord.row % 3));
+  }
 
   const char *getPrintKind() const {
     switch (kind) {
@@ -195,24 +423,36 @@ struct House {
 
 std::ostream &operator<<(std::ostream &os, House const &house);
 
-struct Row : House {
-  Row(unsigned n) : House(n, HouseKind::Row) {}
-  unsigned getLinearID(const Cell *const cell) const override;
-};
+using HouseArray = std::array<std::unique_ptr<House>, 9>;
 
-struct Col : House {
-  Col(unsigned n) : House(n, HouseKind::Col) {}
-  unsigned getLinearID(const Cell *const cell) const override;
-};
+// Identifies a pseudo cage by its cells and sum.
+struct PseudoCageKey {
+  CellSet cells;
+  unsigned sum;
 
-struct Box : House {
-  Box(unsigned n) : House(n, HouseKind::Box) {}
-  unsigned getLinearID(const Cell *const cell) const override;
+  bool operator==(PseudoCageKey const &other) const {
+    return sum == other.sum && cells == other.cells;
+  }
 };
 
-using HouseArray = std::array<std::unique_ptr<House>, 9>;
+namespace std {
+template <> struct hash<PseudoCageKey> {
+  std::size_t operator()(PseudoCageKey const &key) const noexcept {
+    return key.cells.hash() ^ key.sum;
+  }
+};
+} // namespace std
 
 struct Grid {
+  // Where the grid's cages, cage combos and regions are allocated. Restoring a
+  // snapshot rewinds it, as everything allocated since is dropped.
+  std::unique_ptr<Arena> owned_arena;
+  Arena &arena;
+
+  // The solving state proper: every cell's candidates, indexed by cell. The
+  // cells below are views onto this array.
+  CandidateArray candidates;
+
   std::array<std::array<Cell, 9>, 9> cells;
 
   HouseArray rows;
@@ -220,21 +460,44 @@ struct Grid {
   HouseArray boxes;
 
   CageList cages;
+  // Every pseudo cage, oldest first. Regions share pseudo cages with the same
+  // cells and sum, so each is only created, and has its combos worked out,
+  // once.
   CageList pseudo_cages;
+  std::unordered_map<PseudoCageKey, Cage *> pseudo_cage_index;
+
+  std::vector<ArenaPtr<CageComboInfo>> cage_combos;
+  std::vector<ArenaPtr<InnieOutieRegion>> innies_and_outies;
+
+  // Change tracking, so that steps can skip houses which haven't changed since
+  // they last ran on them. A house's cell generation is bumped when its cells'
+  // candidates change, and its cage generation when the combos of a cage
+  // overlapping it do.
+  std::array<unsigned, NumHouses> cell_generations = {};
+  std::array<unsigned, NumHouses> cage_generations = {};
+  // For each step, the generations of each house when it last ran there.
+  std::unordered_map<ColumboStep const *, std::array<unsigned, NumHouses>>
+      step_generations;
+
+  Grid() : Grid(nullptr) {}
+
+  // Uses the given arena, which must outlive the grid, rather than one of its
+  // own. Batch solves reset and reuse one arena for each grid.
+  explicit Grid(Arena *shared_arena)
+      : owned_arena(shared_arena ? nullptr : std::make_unique<Arena>()),
+        arena(shared_arena ? *shared_arena : *owned_arena),
+        cells(makeCells(candidates, std::make_index_sequence<9>{})) {
+    /* Set all candidates by default */
+    candidates.fill(Mask(Mask::AllBits));
 
-  std::vector<std::unique_ptr<CageComboInfo>> cage_combos;
-  std::vector<std::unique_ptr<InnieOutieRegion>> innies_and_outies;
-
-  Grid() {
     for (unsigned i = 0; i < 9; ++i) {
-      rows[i] = std::make_unique<Row>(i);
-      cols[i] = std::make_unique<Col>(i);
-      boxes[i] = std::make_unique<Box>(i);
+      rows[i] = std::make_unique<House>(i, HouseKind::Row);
+      cols[i] = std::make_unique<House>(i, HouseKind::Col);
+      boxes[i] = std::make_unique<House>(i, HouseKind::Box);
     }
 
     for (unsigned row = 0; row < 9; ++row) {
       for (unsigned col = 0; col < 9; ++col) {
-        cells[row][col].coord = {row, col};
         cells[row][col].row = &*rows[row];
         cells[row][col].col = &*cols[col];
         (*rows[row])[col] = &cells[row][col];
@@ -258,17 +521,52 @@ struct Grid {
     }
   }
 
+  ~Grid();
+
   Cell *getCell(const Coord &coord);
 
   Cell *getCell(unsigned y, unsigned x);
 
-  bool initialize(std::ifstream &file, bool v = true);
+  Cell *getCell(unsigned idx) { return &cells[idx / 9][idx % 9]; }
+
+  House *getHouse(unsigned idx);
+
+  bool initialize(std::istream &file, bool v = true);
+
+  // Saves or restores everything that changes while solving: candidates, cage
+  // combos, pseudo cages and innie/outie regions. A snapshot may be restored
+  // any number of times, but not once an older snapshot has been restored.
+  // Steps holding on to per-grid state must be reset after a restore.
+  GridSnapshot snapshot() const;
+  void restore(GridSnapshot const &snapshot);
+
+  // Bumps the generations of the houses which have changed since the last
+  // call.
+  void updateGenerations();
 
   void writeToFile(std::ostream &file);
 
   void assignCageColours();
 
 private:
+  template <std::size_t... Cols>
+  static std::array<Cell, 9> makeRow(CandidateArray &candidates, unsigned row,
+                                     std::index_sequence<Cols...>) {
+    return {{Cell(candidates[cellIndex(row, Cols)],
+                  Coord{row, static_cast<unsigned>(Cols)})...}};
+  }
+
+  template <std::size_t... Rows>
+  static std::array<std::array<Cell, 9>, 9>
+  makeCells(CandidateArray &candidates, std::index_sequence<Rows...> seq) {
+    return {{makeRow(candidates, Rows, seq)...}};
+  }
+
+  // The grid as of the last updateGenerations(): the candidates, and for each
+  // of cage_combos, how many permutations it had and the houses its cage
+  // overlaps.
+  CandidateArray seen_candidates = {};
+  std::vector<std::pair<std::size_t, HouseMask>> seen_cage_combos;
 
   bool validate();
   bool initializeCages();
@@ -276,13 +574,54 @@ private:
   void initializeInnieAndOutieRegions();
 };
 
+// The cells of a cage, in order. Alongside the list it keeps the cells as a
+// CellSet, so membership and overlap queries are O(1). Positions are found by
+// scanning the list, which is short, rather than kept in a table the size of
+// the grid that every copy of the cage would carry. The cells can only be
+// changed through addCell and assign, which keep the set up to date.
+class CageCells {
+public:
+  using value_type = Cell *;
+  using const_iterator = std::vector<Cell *>::const_iterator;
+
+  const_iterator begin() const { return cells.begin(); }
+  const_iterator end() const { return cells.end(); }
+  auto rbegin() const { return cells.rbegin(); }
+  auto rend() const { return cells.rend(); }
+
+  std::size_t size() const { return cells.size(); }
+  bool empty() const { return cells.empty(); }
+
+  Cell *operator[](std::size_t i) const { return cells[i]; }
+
+  std::vector<Cell *> const &list() const { return cells; }
+  CellSet const &set() const { return members; }
+  bool contains(unsigned idx) const { return members.contains(idx); }
+  // The position of the cell's first appearance in the list.
+  std::optional<std::size_t> indexOf(unsigned idx) const;
+
+  void addCell(Cell *cell);
+  void assign(std::vector<Cell *> new_cells);
+
+private:
+  std::vector<Cell *> cells;
+  CellSet members;
+};
+
 struct Cage {
   unsigned sum = 0;
   int colour = 0;
   bool is_pseudo = false;
-  std::vector<Cell *> cells;
+  CageCells cells;
   CageComboInfo *cage_combos = nullptr;
   std::string pseudo_name = "";
+  // The number of active innie/outie regions using this pseudo cage. It's
+  // registered with its cells while there are any.
+  unsigned num_regions = 0;
+  // Whether this is a large pseudo cage whose cells don't all see each other.
+  // It has too many permutations for conflicting-combos-hard, which compares
+  // them pairwise against other cages', to be worth running on.
+  bool is_large_clashing = false;
 
   void addCell(Cell *cell);
   void addCell(Grid *const grid, Coord coord);
@@ -307,11 +646,8 @@ struct Cage {
     }
   }
 
-  std::vector<Cell *>::iterator end() { return cells.end(); }
-  std::vector<Cell *>::iterator begin() { return cells.begin(); }
-
-  std::vector<Cell *>::const_iterator end() const { return cells.end(); }
-  std::vector<Cell *>::const_iterator begin() const { return cells.begin(); }
+  CageCells::const_iterator end() const { return cells.end(); }
+  CageCells::const_iterator begin() const { return cells.begin(); }
 
   bool contains(Cell *c) const;
   bool contains(Cell const *c) const;
@@ -341,6 +677,9 @@ struct Cage {
 
   std::optional<std::size_t> indexOf(Cell const *cell) const;
 
+  CellSet const &getCellSet() const { return cells.set(); }
+  PseudoCageKey getPseudoCageKey() const { return {getCellSet(), sum}; }
+
   int getMinValue() const;
   int getMaxValue() const;
 
@@ -357,7 +696,7 @@ struct CellCageUnit {
   std::vector<Cell *> getCells() const {
     if (cell)
       return {cell};
-    return cage->cells;
+    return cage->cells.list();
   }
 
   bool is_or_contains(Cell *c) const;
@@ -405,7 +744,7 @@ struct InnieOutieRegion {
   Coord max;
 
   // Cells whose contributions to the sum are known
-  std::unique_ptr<Cage> known_cage = std::make_unique<Cage>();
+  ArenaPtr<Cage> known_cage;
   std::vector<std::unique_ptr<InnieOutie>> innies_outies;
 
   // If the region matches 1:1 with a row/col/box, this is it.
@@ -414,7 +753,8 @@ struct InnieOutieRegion {
   unsigned num_cells;
   unsigned expected_sum;
 
-  InnieOutieRegion(Coord _min, Coord _max) : min(_min), max(_max) {
+  InnieOutieRegion(Arena &arena, Coord _min, Coord _max)
+      : min(_min), max(_max), known_cage(arena.make<Cage>()) {
     unsigned rows = 1 + max.row - min.row;
     unsigned cols = 1 + max.col - min.col;
 
@@ -426,9 +766,50 @@ struct InnieOutieRegion {
 
   std::string getName() const;
 
-  std::vector<std::unique_ptr<Cage>> innies;
-  std::vector<std::unique_ptr<Cage>> large_innies;
-  std::vector<std::unique_ptr<Cage>> large_outies;
+  // The region's pseudo cages, which are owned by the grid and may be shared
+  // with other regions.
+  std::vector<Cage *> innies;
+  std::vector<Cage *> large_innies;
+  std::vector<Cage *> large_outies;
+
+  void addPseudoCage(std::vector<Cage *> &list, Cage *cage);
+
+  // Whether this region may still tell us something. Retired regions keep
+  // their pseudo cages so they can be restored, but stop using them.
+  bool active = true;
+  void retire();
+
+  // The parts of the region which change while solving.
+  struct State {
+    struct InnieOutieState {
+      unsigned sum;
+      CageCells inside_cells;
+      CageCells outside_cells;
+    };
+
+    bool active;
+    unsigned known_sum;
+    CageCells known_cells;
+    std::vector<InnieOutieState> innies_outies;
+    std::size_t num_innies;
+    std::size_t num_large_innies;
+    std::size_t num_large_outies;
+  };
+
+  State saveState() const;
+  void restoreState(State const &state);
+
+private:
+  void setPseudoCagesAttached(bool attach);
+};
+
+struct GridSnapshot {
+  CandidateArray candidates;
+  std::vector<std::shared_ptr<CageComboInfo::ComboList>> cage_combos;
+  std::size_t num_pseudo_cages;
+  Arena::Mark arena_mark;
+  std::vector<InnieOutieRegion::State> regions;
+  std::array<InnieOutieRegion *, NumHouses> house_regions;
 };
 
 enum id {
@@ -0,0 +1,97 @@
+#include "exact_cover.h"
+
+ExactCover::ExactCover(unsigned num_items)
+    : nodes(num_items + 1), item_sizes(num_items + 1, 0) {
+  for (unsigned i = 0; i <= num_items; i++) {
+    nodes[i].left = i == 0 ? num_items : i - 1;
+    nodes[i].right = i == num_items ? 0 : i + 1;
+    nodes[i].up = nodes[i].down = nodes[i].item = i;
+  }
+}
+
+void ExactCover::addOption(std::vector<unsigned> const &items) {
+  const unsigned first = static_cast<unsigned>(nodes.size());
+  for (unsigned i = 0, e = items.size(); i != e; i++) {
+    const unsigned idx = first + i;
+    const unsigned item = items[i] + 1;
+    Node node;
+    node.item = item;
+    node.option = num_options;
+    // Append to the bottom of the item's column.
+    node.up = nodes[item].up;
+    node.down = item;
+    nodes[nodes[item].up].down = idx;
+    nodes[item].up = idx;
+    item_sizes[item]++;
+    // Link into a circular row with the option's other nodes.
+    node.left = i == 0 ? first + e - 1 : idx - 1;
+    node.right = i == e - 1 ? first : idx + 1;
+    nodes.push_back(node);
+  }
+  num_options++;
+}
+
+void ExactCover::cover(unsigned item) {
+  nodes[nodes[item].right].left = nodes[item].left;
+  nodes[nodes[item].left].right = nodes[item].right;
+  for (unsigned i = nodes[item].down; i != item; i = nodes[i].down) {
+    for (unsigned j = nodes[i].right; j != i; j = nodes[j].right) {
+      nodes[nodes[j].down].up = nodes[j].up;
+      nodes[nodes[j].up].down = nodes[j].down;
+      item_sizes[nodes[j].item]--;
+    }
+  }
+}
+
+void ExactCover::uncover(unsigned item) {
+  for (unsigned i = nodes[item].up; i != item; i = nodes[i].up) {
+    for (unsigned j = nodes[i].left; j != i; j = nodes[j].left) {
+      item_sizes[nodes[j].item]++;
+      nodes[nodes[j].down].up = j;
+      nodes[nodes[j].up].down = j;
+    }
+  }
+  nodes[nodes[item].right].left = item;
+  nodes[nodes[item].left].right = item;
+}
+
+bool ExactCover::search(std::vector<unsigned> &chosen,
+                        SolutionFn const &on_solution,
+                        StopFn const &should_stop) {
+  if (nodes[Root].right == Root)
+    return on_solution(chosen);
+
+  if (should_stop())
+    return true;
+
+  // Branch on the item with the fewest remaining options.
+  unsigned item = nodes[Root].right;
+  for (unsigned i = nodes[item].right; i != Root; i = nodes[i].right)
+    if (item_sizes[i] < item_sizes[item])
+      item = i;
+
+  if (item_sizes[item] == 0)
+    return false;
+
+  bool stop = false;
+  cover(item);
+  for (unsigned r = nodes[item].down; r != item && !stop; r = nodes[r].down) {
+    chosen.push_back(nodes[r].option);
+    for (unsigned j = nodes[r].right; j != r; j = nodes[j].right)
+      cover(nodes[j].item);
+
+    stop = search(chosen, on_solution, should_stop);
+
+    for (unsigned j = nodes[r].left; j != r; j = nodes[j].left)
+      uncover(nodes[j].item);
+    chosen.pop_back();
+  }
+  uncover(item);
+  return stop;
+}
+
+bool ExactCover::solve(SolutionFn const &on_solution,
+                       StopFn const &should_stop) {
+  std::vector<unsigned> chosen;
+  return search(chosen, on_solution, should_stop);
+}
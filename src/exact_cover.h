@@ -0,0 +1,47 @@
+#ifndef COLUMBO_EXACT_COVER_H
+#define COLUMBO_EXACT_COVER_H
+
+#include <functional>
+#include <vector>
+
+// An exact cover problem, solved with Knuth's Algorithm X using dancing
+// links. Items are numbered from zero and every item must be covered by
+// exactly one of the chosen options. Options are numbered in the order they
+// were added.
+class ExactCover {
+public:
+  using SolutionFn = std::function<bool(std::vector<unsigned> const &)>;
+  using StopFn = std::function<bool()>;
+
+  explicit ExactCover(unsigned num_items);
+
+  void addOption(std::vector<unsigned> const &items);
+
+  unsigned getNumOptions() const { return num_options; }
+
+  // Calls 'on_solution' with the options making up each solution in turn.
+  // The search stops as soon as 'on_solution' returns true, or 'should_stop'
+  // (polled at every node) does. Returns true if the search was cut short.
+  bool solve(SolutionFn const &on_solution, StopFn const &should_stop);
+
+private:
+  struct Node {
+    unsigned left, right, up, down;
+    unsigned item;
+    unsigned option;
+  };
+
+  // Node 0 is the root; nodes 1-N are the item headers.
+  static constexpr unsigned Root = 0;
+
+  std::vector<Node> nodes;
+  std::vector<unsigned> item_sizes;
+  unsigned num_options = 0;
+
+  void cover(unsigned item);
+  void uncover(unsigned item);
+  bool search(std::vector<unsigned> &chosen, SolutionFn const &on_solution,
+              StopFn const &should_stop);
+};
+
+#endif // COLUMBO_EXACT_COVER_H
@@ -1,29 +1,33 @@
 #include "fixed_cell_cleanup.h"
 
-bool PropagateFixedCells::runOnHouse(House &house, const Cell *fixed_cell, bool debug) {
+bool PropagateFixedCells::runOnHouse(Grid *const grid, unsigned house_idx,
+                                     const Cell *fixed_cell, bool debug) {
   bool modified = false;
-  const Mask fixed_mask = fixed_cell->candidates;
+  const unsigned fixed_idx = fixed_cell->getIndex();
+  const Mask fixed_mask = grid->candidates[fixed_idx];
 
   Mask fixed_cells = fixed_mask;
   int removed = 0;
-  for (auto &c : house) {
+  for (unsigned idx : HouseCells[house_idx]) {
     // Not interested in fixed cells
-    if (c == fixed_cell)
+    if (idx == fixed_idx)
       continue;
-    if (c->isFixed()) {
-      if (fixed_cells[c->isFixed() - 1]) {
+    const Mask cands = grid->candidates[idx];
+    if (cands.hasSingleBit()) {
+      if ((fixed_cells & cands).any()) {
         std::stringstream ss;
-        ss << "Cell value " << c->isFixed() << " fixed multiple times in "
-           << house << "!";
+        ss << "Cell value " << (cands.first() + 1)
+           << " fixed multiple times in " << *grid->getHouse(house_idx) << "!";
         throw invalid_grid_exception{ss.str()};
       }
-      fixed_cells.set(c->isFixed() - 1);
+      fixed_cells |= cands;
       continue;
     }
 
+    Cell *c = grid->getCell(idx);
     if (auto intersection = updateCell(c, ~fixed_mask)) {
       modified = true;
-      work_list.insert(c);
+      work_list.insert(idx);
       if (debug) {
         if (!removed++) {
           dbgs() << "Clean Up: removing " << printCandidateString(*intersection)
@@ -11,33 +11,24 @@ struct PropagateFixedCells : ColumboStep {
     bool modified = false;
     bool debug = dbg_opts.debug(getID());
     if (work_list.empty()) {
-      for (auto &r : grid->cells) {
-        for (auto &c : r) {
-          if (c.isFixed()) {
-            work_list.insert(&c);
-          }
+      for (unsigned idx = 0; idx < NumCells; idx++) {
+        if (grid->candidates[idx].hasSingleBit()) {
+          work_list.insert(idx);
         }
       }
     }
 
     while (!work_list.empty()) {
-      Cell *cell = *work_list.begin();
-      work_list.erase(work_list.begin());
+      Cell *cell = grid->getCell(work_list.first());
+      work_list.erase(cell->getIndex());
 
       if (!cell->isFixed()) {
         continue;
       }
 
-      const auto col_id = cell->coord.col;
-      const auto row_id = cell->coord.row;
-      const auto box_id = (col_id / 3) + (row_id / 3) * 3;
-      auto *row = grid->rows[row_id].get();
-      auto *col = grid->cols[col_id].get();
-      auto *box = grid->boxes[box_id].get();
-
-      modified |= runOnHouse(*row, cell, debug);
-      modified |= runOnHouse(*col, cell, debug);
-      modified |= runOnHouse(*box, cell, debug);
+      for (unsigned house_idx : CellHouses[cell->getIndex()]) {
+        modified |= runOnHouse(grid, house_idx, cell, debug);
+      }
     }
     return modified;
   }
@@ -49,9 +40,15 @@ struct PropagateFixedCells : ColumboStep {
 
   void setWorkList(const CellSet &cells) { work_list = cells; }
 
+  void reset() override {
+    ColumboStep::reset();
+    work_list.clear();
+  }
+
 private:
   CellSet work_list;
-  bool runOnHouse(House &house, const Cell *cell, bool debug);
+  bool runOnHouse(Grid *const grid, unsigned house_idx, const Cell *cell,
+                  bool debug);
 };
 
 #endif // COLUMBO_FIXED_CELL_CLEANUP_H
@@ -0,0 +1,370 @@
+#include "generator.h"
+#include "search.h"
+#include "utils.h"
+
+#include <cassert>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+using Solution = std::array<unsigned, NumCells>;
+using CageLayout = std::vector<std::vector<unsigned>>;
+
+// Random numbers drawn without the standard distributions, whose output is
+// left to the implementation, so that a seed gives the same puzzles wherever
+// it's used.
+struct Random {
+  std::mt19937_64 engine;
+
+  Random(std::uint64_t seed, std::uint64_t index) {
+    std::seed_seq seq{static_cast<std::uint32_t>(seed),
+                      static_cast<std::uint32_t>(seed >> 32),
+                      static_cast<std::uint32_t>(index),
+                      static_cast<std::uint32_t>(index >> 32)};
+    engine.seed(seq);
+  }
+
+  unsigned below(std::size_t n) { return static_cast<unsigned>(engine() % n); }
+
+  template <typename T> void shuffle(T *first, std::size_t n) {
+    for (std::size_t i = n; i > 1; i--)
+      std::swap(first[i - 1], first[below(i)]);
+  }
+};
+
+// Fills in the solution from 'idx' onwards, trying each cell's digits in a
+// random order.
+static bool fillSolution(Random &rng, Solution &solution,
+                         std::array<Mask, NumHouses> &used, unsigned idx) {
+  if (idx == NumCells)
+    return true;
+
+  Mask taken;
+  for (unsigned house_idx : CellHouses[idx])
+    taken |= used[house_idx];
+
+  std::array<unsigned, 9> digits;
+  std::size_t num_digits = 0;
+  for (unsigned i : ~taken)
+    digits[num_digits++] = i;
+  rng.shuffle(digits.data(), num_digits);
+
+  for (std::size_t i = 0; i < num_digits; i++) {
+    const unsigned digit = digits[i];
+    for (unsigned house_idx : CellHouses[idx])
+      used[house_idx].set(digit);
+    solution[idx] = digit + 1;
+    if (fillSolution(rng, solution, used, idx + 1))
+      return true;
+    for (unsigned house_idx : CellHouses[idx])
+      used[house_idx].reset(digit);
+  }
+  return false;
+}
+
+static unsigned drawCageSize(Random &rng,
+                             std::array<unsigned, 10> const &weights) {
+  const unsigned total = std::accumulate(weights.begin(), weights.end(), 0u);
+  assert(total && "Expected at least one cage size to have a weight");
+  unsigned r = rng.below(total);
+  for (unsigned size = 1; size < weights.size(); size++) {
+    if (r < weights[size])
+      return size;
+    r -= weights[size];
+  }
+  return 1;
+}
+
+template <typename Fn> static void forEachNeighbour(unsigned idx, Fn fn) {
+  const unsigned row = idx / 9;
+  const unsigned col = idx % 9;
+  if (row > 0)
+    fn(idx - 9);
+  if (row < 8)
+    fn(idx + 9);
+  if (col > 0)
+    fn(idx - 1);
+  if (col < 8)
+    fn(idx + 1);
+}
+
+static unsigned getCageSum(std::vector<unsigned> const &cage,
+                           Solution const &solution) {
+  unsigned sum = 0;
+  for (unsigned idx : cage)
+    sum += solution[idx];
+  return sum;
+}
+
+static bool cageHasDigit(std::vector<unsigned> const &cage,
+                         Solution const &solution, unsigned digit) {
+  return std::any_of(cage.begin(), cage.end(), [&](unsigned idx) {
+    return solution[idx] == digit;
+  });
+}
+
+// Carves the solution into cages, growing each one from a random cell into
+// its neighbours. Returns false if the cages don't fit the options' sums.
+static bool carveCages(Random &rng, Solution const &solution,
+                       GeneratorOptions const &opts, CageLayout &layout) {
+  layout.clear();
+  std::array<int, NumCells> owner;
+  owner.fill(-1);
+
+  std::array<unsigned, NumCells> order;
+  std::iota(order.begin(), order.end(), 0);
+  rng.shuffle(order.data(), order.size());
+
+  std::vector<unsigned> frontier;
+  for (unsigned start : order) {
+    if (owner[start] >= 0)
+      continue;
+    const unsigned target = drawCageSize(rng, opts.size_weights);
+    const int cage_idx = layout.size();
+    auto &cage = layout.emplace_back(1, start);
+    owner[start] = cage_idx;
+    unsigned sum = solution[start];
+
+    while (cage.size() < target || (sum < opts.min_sum && cage.size() < 9)) {
+      frontier.clear();
+      for (unsigned idx : cage) {
+        forEachNeighbour(idx, [&](unsigned n) {
+          if (owner[n] < 0 && sum + solution[n] <= opts.max_sum &&
+              !cageHasDigit(cage, solution, solution[n]) &&
+              std::find(frontier.begin(), frontier.end(), n) == frontier.end())
+            frontier.push_back(n);
+        });
+      }
+      if (frontier.empty())
+        break;
+      const unsigned next = frontier[rng.below(frontier.size())];
+      cage.push_back(next);
+      owner[next] = cage_idx;
+      sum += solution[next];
+    }
+  }
+
+  // Cells boxed in by other cages are left on their own; fold them into a
+  // neighbour unless single-cell cages were asked for.
+  if (!opts.size_weights[1]) {
+    std::vector<int> merge_into;
+    for (auto &cage : layout) {
+      if (cage.size() != 1)
+        continue;
+      const unsigned idx = cage[0];
+      merge_into.clear();
+      forEachNeighbour(idx, [&](unsigned n) {
+        auto const &other = layout[owner[n]];
+        if (owner[n] != owner[idx] && !other.empty() && other.size() < 9 &&
+            getCageSum(other, solution) + solution[idx] <= opts.max_sum &&
+            !cageHasDigit(other, solution, solution[idx]))
+          merge_into.push_back(owner[n]);
+      });
+      if (merge_into.empty())
+        continue;
+      const int other_idx = merge_into[rng.below(merge_into.size())];
+      layout[other_idx].push_back(idx);
+      owner[idx] = other_idx;
+      cage.clear();
+    }
+    layout.erase(std::remove_if(layout.begin(), layout.end(),
+                                [](auto const &cage) { return cage.empty(); }),
+                 layout.end());
+  }
+
+  return std::all_of(layout.begin(), layout.end(), [&](auto const &cage) {
+    const unsigned sum = getCageSum(cage, solution);
+    return sum >= opts.min_sum && sum <= opts.max_sum;
+  });
+}
+
+static bool isConnected(std::vector<unsigned> const &cells) {
+  std::vector<unsigned> reached{cells[0]};
+  for (std::size_t i = 0; i < reached.size(); i++) {
+    forEachNeighbour(reached[i], [&](unsigned n) {
+      if (std::find(cells.begin(), cells.end(), n) != cells.end() &&
+          std::find(reached.begin(), reached.end(), n) == reached.end())
+        reached.push_back(n);
+    });
+  }
+  return reached.size() == cells.size();
+}
+
+// Splits a cage holding one of the cells where a second solution differs
+// from ours, which usually rules that solution out while keeping the rest of
+// the layout. Returns false if no such cage can be split.
+static bool splitCage(Random &rng, Solution const &solution,
+                      GeneratorOptions const &opts,
+                      std::vector<unsigned> differing, CageLayout &layout) {
+  const unsigned min_size = opts.size_weights[1] ? 1 : 2;
+  rng.shuffle(differing.data(), differing.size());
+
+  std::vector<unsigned> part, rest;
+  for (unsigned idx : differing) {
+    auto &cage = *std::find_if(layout.begin(), layout.end(), [idx](auto &c) {
+      return std::find(c.begin(), c.end(), idx) != c.end();
+    });
+    if (cage.size() < 2 * min_size)
+      continue;
+
+    for (unsigned tries = 0; tries < 8; tries++) {
+      const unsigned target =
+          min_size + rng.below(cage.size() - 2 * min_size + 1);
+      part.assign(1, idx);
+      while (part.size() < target) {
+        rest.clear();
+        for (unsigned c : part)
+          forEachNeighbour(c, [&](unsigned n) {
+            if (std::find(cage.begin(), cage.end(), n) != cage.end() &&
+                std::find(part.begin(), part.end(), n) == part.end() &&
+                std::find(rest.begin(), rest.end(), n) == rest.end())
+              rest.push_back(n);
+          });
+        part.push_back(rest[rng.below(rest.size())]);
+      }
+
+      rest.clear();
+      for (unsigned c : cage)
+        if (std::find(part.begin(), part.end(), c) == part.end())
+          rest.push_back(c);
+      if (!isConnected(rest) || getCageSum(part, solution) < opts.min_sum ||
+          getCageSum(rest, solution) < opts.min_sum)
+        continue;
+
+      cage = part;
+      layout.push_back(rest);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Builds the unsolved grid through the sudoku file format, so that it's set
+// up exactly as a grid read from a file would be.
+static std::unique_ptr<Grid> makeGrid(CageLayout const &layout,
+                                      Solution const &solution) {
+  std::stringstream ss;
+  for (unsigned row = 0; row < 9; row++) {
+    for (unsigned col = 0; col < 9; col++)
+      ss << (col ? " " : "") << "0x1ff";
+    ss << "\n";
+  }
+  ss << "\n";
+  for (auto const &cage : layout) {
+    ss << getCageSum(cage, solution);
+    for (unsigned idx : cage)
+      ss << ' ' << getRowID(idx / 9, /*rowcol*/ false) << idx % 9;
+    ss << "\n";
+  }
+
+  auto grid = std::make_unique<Grid>();
+  if (grid->initialize(ss))
+    return nullptr;
+  return grid;
+}
+
+Generator::Generator(GeneratorOptions const &opts) : opts(opts) {
+  initializeAllSteps(steps, step_map);
+  [[maybe_unused]] bool err = strat.initializeDefault(step_map);
+  assert(!err && "Unknown step");
+  easy.main_block = std::make_unique<Block>(100);
+  for (auto *step : strat.main_block->steps)
+    if (getStepDifficulty(step->getID()) == Difficulty::Easy)
+      easy.main_block->steps.push_back(step);
+}
+
+// Whether the grid has a unique solution, found by searching its remaining
+// cage permutations directly. Otherwise, records where the other solution
+// found differs from ours, if it's to hand.
+bool Generator::hasUniqueSolution(Grid *const grid, Solution const &solution,
+                                  std::vector<unsigned> &differing) {
+  SearchOptions search_opts;
+  search_opts.engine = SearchEngine::DLX;
+  search_opts.time_limit.reset();
+  search_opts.max_guesses = opts.max_search_guesses;
+  search_opts.max_solutions = 2;
+  SearchStats stats =
+      searchGrid(grid, strat, search_opts, DebugOptions{});
+  if (stats.is_complete)
+    for (unsigned idx = 0; idx < NumCells; idx++)
+      if (grid->candidates[idx] != Mask(1 << (solution[idx] - 1)))
+        differing.push_back(idx);
+  return stats.num_solutions == 1 && !stats.timed_out;
+}
+
+// Rates the puzzle as --rate would, by the hardest step the default strategy
+// needs to solve it, or returns nothing if it doesn't have a unique solution.
+// The steps only ever eliminate candidates which can't be part of any
+// solution, so a grid they complete has just the one. Most random layouts of
+// cages have several solutions, and searching what the Easy steps left turns
+// them away far quicker than the harder steps would. The grid is left
+// unsolved.
+std::optional<Difficulty> Generator::rate(GeneratedPuzzle &puzzle,
+                                          std::vector<unsigned> &differing) {
+  Grid *const grid = puzzle.grid.get();
+  const GridSnapshot unsolved = grid->snapshot();
+  const DebugOptions dbg_opts;
+
+  Rating rating;
+  try {
+    easy.resetSteps();
+    const bool is_easy = easy.solveGrid(grid, dbg_opts).is_complete;
+    // The default strategy can't rate a grid Easy if its Easy steps alone
+    // couldn't solve it.
+    if (!is_easy && opts.difficulty == Difficulty::Easy) {
+      grid->restore(unsolved);
+      return std::nullopt;
+    }
+    if (!is_easy && !hasUniqueSolution(grid, puzzle.solution, differing)) {
+      grid->restore(unsolved);
+      return std::nullopt;
+    }
+    grid->restore(unsolved);
+
+    strat.resetSteps();
+    strat.rating = &rating;
+    if (!strat.solveGrid(grid, dbg_opts).is_complete)
+      rating.recordSearch();
+    strat.rating = nullptr;
+    grid->restore(unsolved);
+  } catch (invalid_grid_exception &) {
+    strat.rating = nullptr;
+    grid->restore(unsolved);
+    return std::nullopt;
+  }
+
+  const Difficulty difficulty = rating.getDifficulty();
+  if (opts.difficulty && difficulty != *opts.difficulty)
+    return std::nullopt;
+  return difficulty;
+}
+
+std::optional<GeneratedPuzzle> Generator::generate(std::uint64_t seed,
+                                                   std::uint64_t index) {
+  Random rng(seed, index);
+  GeneratedPuzzle puzzle;
+
+  std::array<Mask, NumHouses> used{};
+  fillSolution(rng, puzzle.solution, used, 0);
+
+  CageLayout layout;
+  std::vector<unsigned> differing;
+  bool carve = true;
+  for (unsigned attempt = 1; attempt <= opts.max_attempts; attempt++) {
+    puzzle.num_attempts = attempt;
+    if (carve && !carveCages(rng, puzzle.solution, opts, layout))
+      continue;
+    puzzle.grid = makeGrid(layout, puzzle.solution);
+    differing.clear();
+    if (puzzle.grid) {
+      if (auto difficulty = rate(puzzle, differing)) {
+        puzzle.difficulty = *difficulty;
+        return puzzle;
+      }
+    }
+    carve = differing.empty() ||
+            !splitCage(rng, puzzle.solution, opts, differing, layout);
+  }
+
+  return std::nullopt;
+}
@@ -0,0 +1,68 @@
+#ifndef COLUMBO_GENERATOR_H
+#define COLUMBO_GENERATOR_H
+
+#include "all_steps.h"
+#include "defs.h"
+#include "strategy.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+struct GeneratorOptions {
+  // Relative weights of each cage size, indexed by the size. Single-cell
+  // cages are only kept when they have a weight; otherwise any left over are
+  // merged into a neighbouring cage where possible.
+  std::array<unsigned, 10> size_weights = {0, 0, 30, 35, 20, 10, 5, 0, 0, 0};
+  // The range every cage's sum must lie within.
+  unsigned min_sum = 1;
+  unsigned max_sum = 45;
+  // Only keep puzzles of this difficulty.
+  std::optional<Difficulty> difficulty;
+  // Give up on a puzzle after trying this many cage layouts.
+  unsigned max_attempts = 1000;
+  // How many guesses to spend proving that a puzzle beyond the steps is
+  // unique. A time limit would make the puzzles depend on how fast they're
+  // generated.
+  unsigned max_search_guesses = 50000;
+};
+
+struct GeneratedPuzzle {
+  // The digits of the puzzle's unique solution.
+  std::array<unsigned, NumCells> solution;
+  // The unsolved puzzle.
+  std::unique_ptr<Grid> grid;
+  Difficulty difficulty = Difficulty::Easy;
+  unsigned num_attempts = 0;
+};
+
+// Generates killer sudokus from a solved grid, carving it into random cages
+// until the cages have a unique solution. Steps keep state while solving, so
+// each thread needs its own generator.
+class Generator {
+public:
+  explicit Generator(GeneratorOptions const &opts);
+
+  // Generates the puzzle identified by 'seed' and 'index'. The pair always
+  // gives the same puzzle, whichever thread and platform generates it.
+  // Returns nothing if no layout of cages worked within 'max_attempts'.
+  std::optional<GeneratedPuzzle> generate(std::uint64_t seed,
+                                          std::uint64_t index);
+
+private:
+  GeneratorOptions opts;
+  StepList steps;
+  StepIDMap step_map;
+  // The default strategy, which rates puzzles as --rate does, and its Easy
+  // steps, which quickly show most puzzles to be unique.
+  Strategy strat;
+  Strategy easy;
+
+  bool hasUniqueSolution(Grid *const grid,
+                         std::array<unsigned, NumCells> const &solution,
+                         std::vector<unsigned> &differing);
+  std::optional<Difficulty> rate(GeneratedPuzzle &puzzle,
+                                 std::vector<unsigned> &differing);
+};
+
+#endif // COLUMBO_GENERATOR_H
@@ -0,0 +1,84 @@
+#ifndef COLUMBO_GRID_TABLES_H
+#define COLUMBO_GRID_TABLES_H
+
+#include "mask.h"
+
+#include <array>
+#include <cstdint>
+
+// An index-based description of the grid's layout. Cells are numbered 0-80 in
+// row-major order. Houses are numbered with the rows first (0-8), then the
+// columns (9-17), then the boxes (18-26).
+
+using CellIdx = uint8_t;
+using HouseIdx = uint8_t;
+
+constexpr unsigned NumCells = 81;
+constexpr unsigned NumHouses = 27;
+
+// The candidates of every cell in the grid, indexed by cell.
+using CandidateArray = std::array<Mask, NumCells>;
+
+constexpr unsigned cellIndex(unsigned row, unsigned col) {
+  return row * 9 + col;
+}
+
+constexpr unsigned rowHouseIndex(unsigned row) { return row; }
+constexpr unsigned colHouseIndex(unsigned col) { return 9 + col; }
+constexpr unsigned boxHouseIndex(unsigned box) { return 18 + box; }
+
+constexpr unsigned boxNumber(unsigned row, unsigned col) {
+  return (row / 3) * 3 + (col / 3);
+}
+
+// The cells of each house. A cell's position in its house's list is its
+// linear ID within that house: left-to-right in rows, top-to-bottom in
+// columns, and row-major in boxes.
+inline constexpr std::array<std::array<CellIdx, 9>, NumHouses> HouseCells =
+    [] {
+      std::array<std::array<CellIdx, 9>, NumHouses> houses{};
+      for (unsigned i = 0; i < 9; i++) {
+        for (unsigned j = 0; j < 9; j++) {
+          houses[rowHouseIndex(i)][j] = static_cast<CellIdx>(cellIndex(i, j));
+          houses[colHouseIndex(i)][j] = static_cast<CellIdx>(cellIndex(j, i));
+          unsigned row = (i / 3) * 3 + j / 3;
+          unsigned col = (i % 3) * 3 + j % 3;
+          houses[boxHouseIndex(i)][j] =
+              static_cast<CellIdx>(cellIndex(row, col));
+        }
+      }
+      return houses;
+    }();
+
+// The row, column and box (in that order) containing each cell.
+inline constexpr std::array<std::array<HouseIdx, 3>, NumCells> CellHouses =
+    [] {
+      std::array<std::array<HouseIdx, 3>, NumCells> cell_houses{};
+      for (unsigned row = 0; row < 9; row++) {
+        for (unsigned col = 0; col < 9; col++) {
+          auto &houses = cell_houses[cellIndex(row, col)];
+          houses[0] = static_cast<HouseIdx>(rowHouseIndex(row));
+          houses[1] = static_cast<HouseIdx>(colHouseIndex(col));
+          houses[2] = static_cast<HouseIdx>(boxHouseIndex(boxNumber(row, col)));
+        }
+      }
+      return cell_houses;
+    }();
+
+// The 20 other cells which share a house with each cell, in index order.
+inline constexpr std::array<std::array<CellIdx, 20>, NumCells> CellPeers = [] {
+  std::array<std::array<CellIdx, 20>, NumCells> peers{};
+  for (unsigned idx = 0; idx < NumCells; idx++) {
+    unsigned n = 0;
+    for (unsigned other = 0; other < NumCells; other++) {
+      if (other == idx)
+        continue;
+      if (other / 9 == idx / 9 || other % 9 == idx % 9 ||
+          boxNumber(other / 9, other % 9) == boxNumber(idx / 9, idx % 9))
+        peers[idx][n++] = static_cast<CellIdx>(other);
+    }
+  }
+  return peers;
+}();
+
+#endif // COLUMBO_GRID_TABLES_H
@@ -2,9 +2,10 @@
 
 // Search a given house for a 'single': a cell that is the only that is the
 // only in the house to potentially contain a value
-bool EliminateHiddenSinglesStep::runOnHouse(House &house, bool debug) {
+bool EliminateHiddenSinglesStep::runOnHouse(
+    Grid *const grid, unsigned house_idx, CellCountMaskArray const &cell_masks,
+    bool debug) {
   bool modified = false;
-  CellCountMaskArray cell_masks = collectCellCountMaskInfo(house);
 
   for (unsigned i = 0, e = cell_masks.size(); i < e; ++i) {
     const Mask cell_mask = cell_masks[i];
@@ -15,25 +16,20 @@ bool EliminateHiddenSinglesStep::runOnHouse(House &house, bool debug) {
       continue;
     }
 
-    Cell *cell = nullptr;
-    for (unsigned x = 0; x < 9; ++x) {
-      if (cell_mask[x]) {
-        cell = house[x];
-        break;
-      }
-    }
-
-    if (cell->isFixed()) {
+    const unsigned cell_idx = HouseCells[house_idx][cell_mask.first()];
+    if (grid->candidates[cell_idx].hasSingleBit()) {
       continue;
     }
 
+    Cell *cell = grid->getCell(cell_idx);
     if (debug) {
       dbgs() << "Hidden Singles: " << cell->coord << " set to " << (i + 1)
-             << "; unique in " << house.getPrintKind() << "\n";
+             << "; unique in " << grid->getHouse(house_idx)->getPrintKind()
+             << "\n";
     }
 
     modified = true;
-    changed.insert(cell);
+    changed.insert(cell->getIndex());
     const Mask mask = 1 << i;
 
     cell->candidates = mask;
@@ -13,25 +13,32 @@ struct EliminateHiddenSinglesStep : ColumboStep {
     changed.clear();
     bool modified = false;
     bool debug = dbg_opts.debug(getID());
-    for (auto &row : grid->rows) {
-      modified |= runOnHouse(*row, debug);
-    }
-    for (auto &col : grid->cols) {
-      modified |= runOnHouse(*col, debug);
-    }
-    for (auto &box : grid->boxes) {
-      modified |= runOnHouse(*box, debug);
+    const HouseMask houses = getChangedHouses(grid);
+    HouseCellCountMasks house_masks =
+        collectHouseCellCountMasks(grid->candidates);
+    for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++) {
+      if (!houses[house_idx])
+        continue;
+      if (runOnHouse(grid, house_idx, house_masks[house_idx], debug)) {
+        modified = true;
+        // Fixing a cell changes the masks of the other houses it is in.
+        house_masks = collectHouseCellCountMasks(grid->candidates);
+      }
+      markSeen(grid, house_idx);
     }
     return modified;
   }
 
+  StepScope getScope() const override { return StepScope::House; }
+
   virtual void anchor() override;
 
   const char *getID() const override { return "hidden-singles"; }
   const char *getName() const override { return "Hidden Singles"; }
 
 private:
-  bool runOnHouse(House &house, bool debug);
+  bool runOnHouse(Grid *const grid, unsigned house_idx,
+                  CellCountMaskArray const &cell_masks, bool debug);
 };
 
 template <int N> struct HiddenInfo {
@@ -80,18 +87,18 @@ template <int N> struct PairsOrTriplesOrQuadsStep : ColumboStep {
     changed.clear();
     bool modified = false;
     bool debug = dbg_opts.debug(getID());
-    for (auto &row : grid->rows) {
-      modified |= eliminateHiddens(*row, debug);
-    }
-    for (auto &col : grid->cols) {
-      modified |= eliminateHiddens(*col, debug);
-    }
-    for (auto &box : grid->boxes) {
-      modified |= eliminateHiddens(*box, debug);
+    const HouseMask houses = getChangedHouses(grid);
+    for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++) {
+      if (!houses[house_idx])
+        continue;
+      modified |= eliminateHiddens(*grid->getHouse(house_idx), debug);
+      markSeen(grid, house_idx);
     }
     return modified;
   }
 
+  StepScope getScope() const override { return StepScope::House; }
+
 protected:
   bool eliminateHiddens(House &house, bool debug);
 };
@@ -105,9 +112,8 @@ bool PairsOrTriplesOrQuadsStep<N>::eliminateHiddens(House &house, bool debug) {
     hidden_infos[i].candidates = 1 << i;
 
   for (auto *cell : house)
-    for (unsigned i = 0, e = cell->candidates.size(); i != e; i++)
-      if (cell->candidates[i])
-        hidden_infos[i].addDef(CellCageUnit{cell});
+    for (unsigned i : cell->candidates)
+      hidden_infos[i].addDef(CellCageUnit{cell});
 
   for (unsigned i = 0, e = 9; i != e; i++) {
     if (hidden_infos[i].size == 1 || hidden_infos[i].invalid)
@@ -77,7 +77,7 @@ static bool parseCoordSet(Grid *grid, Cage *cage, const Tok &tok) {
   return false;
 }
 
-static bool initializeGridFromFile(std::ifstream &file, Grid *grid) {
+static bool initializeGridFromFile(std::istream &file, Grid *grid) {
   std::string content((std::istreambuf_iterator<char>(file)),
                       (std::istreambuf_iterator<char>()));
   Tok tok;
@@ -146,7 +146,7 @@ static bool initializeGridFromFile(std::ifstream &file, Grid *grid) {
     }
 
     const int cage_sum = tok.getNum();
-    auto cage = std::make_unique<Cage>(static_cast<unsigned>(cage_sum));
+    auto cage = grid->arena.make<Cage>(static_cast<unsigned>(cage_sum));
 
     // Consume the sum
     tok = lex.lex();
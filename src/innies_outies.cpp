@@ -9,15 +9,13 @@
 bool EliminateOneCellInniesAndOutiesStep::reduceCombinations(
     const InnieOutieRegion &region, Cage &cage, unsigned sum,
     const char *cage_type, unsigned sum_lhs, unsigned sum_rhs, bool debug) {
-  auto subsets_storage = std::make_unique<std::vector<IntList>>();
-  auto subsets = subsets_storage.get();
-
   if (!cage.cage_combos)
     return false;
 
+  PermutationList subsets;
   for (auto &combo : *cage.cage_combos)
-    for (auto &v : combo.getPermutations())
-      subsets->push_back(v);
+    for (Permutation v : combo.getPermutations())
+      subsets.push_back(v);
 
   bool modified = false;
   bool have_printed_region = false;
@@ -25,7 +23,7 @@ bool EliminateOneCellInniesAndOutiesStep::reduceCombinations(
     Mask possibles_mask = 0u;
     Cell *cell = cage[i];
 
-    for (auto &subset : *subsets)
+    for (Permutation subset : subsets)
       possibles_mask |= (1 << (subset[i] - 1));
 
     if (updateCell(cell, possibles_mask)) {
@@ -48,7 +46,7 @@ bool EliminateOneCellInniesAndOutiesStep::reduceCombinations(
                   << printCandidateString(possibles_mask) << "\n";
       }
       modified |= true;
-      changed.insert(cell);
+      changed.insert(cell->getIndex());
       // TODO: Must this do region maintenance?
     }
   }
@@ -56,23 +54,34 @@ bool EliminateOneCellInniesAndOutiesStep::reduceCombinations(
   return modified;
 }
 
+// Removes the fixed cells from the cage, returning the sum of their values.
+// If given, 'known_cage' gains the removed cells.
+static unsigned removeFixedCells(Cage &cage, Cage *known_cage) {
+  unsigned sum = 0;
+  std::vector<Cell *> unfixed;
+  for (Cell *c : cage) {
+    if (unsigned value = c->isFixed()) {
+      sum += value;
+      if (known_cage)
+        known_cage->cells.addCell(c);
+    } else {
+      unfixed.push_back(c);
+    }
+  }
+  if (sum)
+    cage.cells.assign(std::move(unfixed));
+  return sum;
+}
+
 // TODO: InnieOutieRegion method?
 void EliminateOneCellInniesAndOutiesStep::performRegionMaintenance(
     InnieOutieRegion &region) const {
 
   // Remove fixed cells from innie cages
   for (auto &innie : region.innies_outies) {
-    unsigned sum = 0;
-    auto i = std::remove_if(std::begin(*innie->inside_cage),
-                            std::end(*innie->inside_cage), [&sum](Cell *c) {
-                              sum += c->isFixed();
-                              return c->isFixed() != 0;
-                            });
+    unsigned sum = removeFixedCells(*innie->inside_cage, region.known_cage.get());
     innie->sum -= sum;
     region.known_cage->sum += sum;
-    region.known_cage->cells.insert(std::end(*region.known_cage), i,
-                                    std::end(*innie->inside_cage));
-    innie->inside_cage->cells.erase(i, std::end(*innie->inside_cage));
   }
 
   // Clean up innies/outies with no cells left
@@ -85,16 +94,8 @@ void EliminateOneCellInniesAndOutiesStep::performRegionMaintenance(
                      }),
       std::end(region.innies_outies));
 
-  for (auto &outie : region.innies_outies) {
-    unsigned sum = 0;
-    auto i = std::remove_if(std::begin(*outie->outside_cage),
-                            std::end(*outie->outside_cage), [&sum](Cell *c) {
-                              sum += c->isFixed();
-                              return c->isFixed() != 0;
-                            });
-    outie->sum -= sum;
-    outie->outside_cage->cells.erase(i, std::end(*outie->outside_cage));
-  }
+  for (auto &outie : region.innies_outies)
+    outie->sum -= removeFixedCells(*outie->outside_cage, nullptr);
 
   // Clean up outies with no cells left
   unsigned sum = 0;
@@ -114,9 +115,8 @@ void EliminateOneCellInniesAndOutiesStep::performRegionMaintenance(
                             return true;
                           });
   region.known_cage->sum += sum;
-  region.known_cage->cells.insert(std::end(region.known_cage->cells),
-                                 std::begin(cells_to_add),
-                                 std::end(cells_to_add));
+  for (Cell *c : cells_to_add)
+    region.known_cage->cells.addCell(c);
   region.innies_outies.erase(i, std::end(region.innies_outies));
 }
 
@@ -265,17 +265,15 @@ bool EliminateOneCellInniesAndOutiesStep::runOnRegion(
       if (region.innies_outies[i]->outside_cage->empty())
         continue;
       outside.sum = region.innies_outies[i]->sum;
-      outside.cells.insert(std::end(outside.cells),
-                           std::begin(*region.innies_outies[i]->outside_cage),
-                           std::end(*region.innies_outies[i]->outside_cage));
+      for (Cell *c : *region.innies_outies[i]->outside_cage)
+        outside.cells.addCell(c);
       for (unsigned j = 0; j < num_innie_outies; j++) {
         if (i == j)
           continue;
         if (region.innies_outies[j]->inside_cage->empty())
           continue;
-        inside.cells.insert(std::end(inside.cells),
-                            std::begin(*region.innies_outies[j]->inside_cage),
-                            std::end(*region.innies_outies[j]->inside_cage));
+        for (Cell *c : *region.innies_outies[j]->inside_cage)
+          inside.cells.addCell(c);
       }
       if (inside.empty())
         continue;
@@ -295,18 +293,16 @@ bool EliminateOneCellInniesAndOutiesStep::runOnRegion(
       Cage inside{0, true}, outside{0, true};
       if (region.innies_outies[i]->inside_cage->empty())
         continue;
-      inside.cells.insert(std::end(inside.cells),
-                          std::begin(*region.innies_outies[i]->inside_cage),
-                          std::end(*region.innies_outies[i]->inside_cage));
+      for (Cell *c : *region.innies_outies[i]->inside_cage)
+        inside.cells.addCell(c);
       for (unsigned j = 0; j < num_innie_outies; j++) {
         if (i == j)
           continue;
         if (region.innies_outies[j]->outside_cage->empty())
           continue;
         outside.sum += region.innies_outies[j]->sum;
-        outside.cells.insert(std::end(outside.cells),
-                             std::begin(*region.innies_outies[j]->outside_cage),
-                             std::end(*region.innies_outies[j]->outside_cage));
+        for (Cell *c : *region.innies_outies[j]->outside_cage)
+          outside.cells.addCell(c);
       }
       if (outside.empty())
         continue;
@@ -340,24 +336,23 @@ bool EliminateOneCellInniesAndOutiesStep::runOnRegion(
 
 bool EliminateOneCellInniesAndOutiesStep::runOnInnies(
     Grid *const grid, InnieOutieRegion &region,
-    std::vector<std::unique_ptr<Cage>> &innies_list, int min_size, int max_size,
-    bool debug) {
-  auto pseudo_cage = std::make_unique<Cage>(0, true);
+    std::vector<Cage *> &innies_list, int min_size, int max_size, bool debug) {
+  Cage pseudo_cage(0, true);
   for (auto &io : region.innies_outies)
     for (auto *c : *io->inside_cage)
-      pseudo_cage->cells.push_back(c);
+      pseudo_cage.cells.addCell(c);
 
-  if (pseudo_cage->empty())
+  if (pseudo_cage.empty())
     return false;
 
   if (region.known_cage->sum >= region.expected_sum)
     throw invalid_grid_exception{"invalid set of innies"};
 
-  if (pseudo_cage->size() < min_size || pseudo_cage->size() > max_size)
+  if (pseudo_cage.size() < min_size || pseudo_cage.size() > max_size)
     return false;
 
-  pseudo_cage->pseudo_name = region.getName() + " innies";
-  pseudo_cage->sum = region.expected_sum - region.known_cage->sum;
+  pseudo_cage.pseudo_name = region.getName() + " innies";
+  pseudo_cage.sum = region.expected_sum - region.known_cage->sum;
   Cage *the_cage =
       getOrCreatePseudoCage(grid, region, innies_list, pseudo_cage);
   return reduceCombinations(region, *the_cage, the_cage->sum, "innie",
@@ -374,29 +369,29 @@ bool EliminateOneCellInniesAndOutiesStep::runOnInnies(
 //   |..x|XX.|...|
 //   |..x|XX.|...|
 bool EliminateOneCellInniesAndOutiesStep::trySplitOutieCage(
-    Grid *const grid, std::unique_ptr<Cage> &pseudo_cage,
-    InnieOutieRegion &region, std::vector<std::unique_ptr<Cage>> &outies_list,
-    std::vector<House const *> &houses, bool debug) {
+    Grid *const grid, Cage const &pseudo_cage, InnieOutieRegion &region,
+    std::vector<Cage *> &outies_list, std::vector<House const *> &houses,
+    bool debug) {
   for (auto const *house : houses) {
     if (!house->region)
       continue;
     for (auto &innie_cage : house->region->innies) {
       if (std::all_of(std::begin(*innie_cage), std::end(*innie_cage),
                       [&pseudo_cage](Cell const *cell) {
-                        return pseudo_cage->contains(cell);
+                        return pseudo_cage.contains(cell);
                       })) {
-        if (innie_cage->sum >= pseudo_cage->sum) {
+        if (innie_cage->sum >= pseudo_cage.sum) {
           std::stringstream ss;
           ss << "Split cage candidate " << *innie_cage
-             << " has a greater sum than its parent " << *pseudo_cage << "\n";
+             << " has a greater sum than its parent " << pseudo_cage << "\n";
           throw invalid_grid_exception{ss.str()};
         }
-        auto split_pseudo_cage = std::make_unique<Cage>(0, true);
-        split_pseudo_cage->pseudo_name = region.getName() + " split outies";
-        split_pseudo_cage->sum = pseudo_cage->sum - innie_cage->sum;
-        for (auto *c : *pseudo_cage) {
+        Cage split_pseudo_cage(0, true);
+        split_pseudo_cage.pseudo_name = region.getName() + " split outies";
+        split_pseudo_cage.sum = pseudo_cage.sum - innie_cage->sum;
+        for (auto *c : pseudo_cage) {
           if (!innie_cage->contains(c))
-            split_pseudo_cage->cells.push_back(c);
+            split_pseudo_cage.cells.addCell(c);
         }
         Cage *the_split_cage = getOrCreatePseudoCage(
             grid, region, region.large_outies, split_pseudo_cage);
@@ -416,30 +411,29 @@ bool EliminateOneCellInniesAndOutiesStep::trySplitOutieCage(
 
 bool EliminateOneCellInniesAndOutiesStep::runOnOuties(
     Grid *const grid, InnieOutieRegion &region,
-    std::vector<std::unique_ptr<Cage>> &outies_list, int min_size, int max_size,
-    bool debug) {
-  auto pseudo_cage = std::make_unique<Cage>(0, true);
+    std::vector<Cage *> &outies_list, int min_size, int max_size, bool debug) {
+  Cage pseudo_cage(0, true);
   unsigned outie_cage_sum = 0;
   for (auto &io : region.innies_outies) {
     outie_cage_sum += io->sum;
     for (auto *c : *io->outside_cage)
-      pseudo_cage->cells.push_back(c);
+      pseudo_cage.cells.addCell(c);
   }
-  if (pseudo_cage->empty())
+  if (pseudo_cage.empty())
     return false;
 
   if (region.known_cage->sum + outie_cage_sum <= region.expected_sum)
     throw invalid_grid_exception{"invalid set of outies"};
 
-  if (pseudo_cage->size() < min_size || pseudo_cage->size() > max_size)
+  if (pseudo_cage.size() < min_size || pseudo_cage.size() > max_size)
     return false;
 
-  pseudo_cage->pseudo_name = region.getName() + " outies";
-  pseudo_cage->sum =
+  pseudo_cage.pseudo_name = region.getName() + " outies";
+  pseudo_cage.sum =
       region.known_cage->sum + outie_cage_sum - region.expected_sum;
 
   std::set<House const *> rows, cols, boxes;
-  for (auto *cell : *pseudo_cage) {
+  for (auto *cell : pseudo_cage) {
     rows.insert(cell->row);
     cols.insert(cell->col);
     boxes.insert(cell->box);
@@ -7,6 +7,7 @@
 #include "debug.h"
 
 #include <memory>
+#include <optional>
 #include <algorithm>
 
 struct EliminateOneCellInniesAndOutiesStep : ColumboStep {
@@ -18,10 +19,11 @@ struct EliminateOneCellInniesAndOutiesStep : ColumboStep {
     std::vector<InnieOutieRegion *> to_remove;
 
     for (auto &region : *innies_and_outies) {
-      modified |= runOnRegion(grid, *region, to_remove, debug);
+      if (region->active)
+        modified |= runOnRegion(grid, *region, to_remove, debug);
     }
 
-    // Remove uninteresting innie & outie regions
+    // Retire uninteresting innie & outie regions
     while (!to_remove.empty()) {
       auto *ptr = to_remove.back();
       to_remove.pop_back();
@@ -32,11 +34,7 @@ struct EliminateOneCellInniesAndOutiesStep : ColumboStep {
         ptr->house->region = nullptr;
       }
 
-      auto iter =
-          std::remove_if(innies_and_outies->begin(), innies_and_outies->end(),
-                         [ptr](auto &p) { return &*p == ptr; });
-
-      innies_and_outies->erase(iter, innies_and_outies->end());
+      ptr->retire();
     }
 
     return modified;
@@ -53,14 +51,14 @@ protected:
                           unsigned sum_rhs, bool debug);
 
   bool runOnInnies(Grid *const grid, InnieOutieRegion &region,
-                   std::vector<std::unique_ptr<Cage>> &innies_list, int min,
-                   int max, bool debug);
+                   std::vector<Cage *> &innies_list, int min, int max,
+                   bool debug);
   bool runOnOuties(Grid *const grid, InnieOutieRegion &region,
-                   std::vector<std::unique_ptr<Cage>> &innies_list, int min,
-                   int max, bool debug);
-  bool trySplitOutieCage(Grid *const grid, std::unique_ptr<Cage> &pseudo_cage,
+                   std::vector<Cage *> &innies_list, int min, int max,
+                   bool debug);
+  bool trySplitOutieCage(Grid *const grid, Cage const &pseudo_cage,
                          InnieOutieRegion &region,
-                         std::vector<std::unique_ptr<Cage>> &outies_list,
+                         std::vector<Cage *> &outies_list,
                          std::vector<House const *> &houses, bool debug);
 
 private:
@@ -93,47 +91,84 @@ struct EliminateHardInniesAndOutiesStep
   virtual void anchor() override;
 };
 
-static inline Cage *
-getOrCreatePseudoCage(Grid *const grid, InnieOutieRegion &,
-                      std::vector<std::unique_ptr<Cage>> &cage_list,
-                      std::unique_ptr<Cage> &pseudo_cage) {
-  // Check whether we've already computed this cage.
+// The most permutations a large clashing pseudo cage may have and still get
+// combos.
+static constexpr std::size_t MaxPseudoCagePerms = 5000;
+
+static inline Cage *getOrCreatePseudoCage(Grid *const grid,
+                                          InnieOutieRegion &region,
+                                          std::vector<Cage *> &cage_list,
+                                          Cage const &pseudo_cage) {
+  // Check whether we've already computed this cage. Most cages are found
+  // here, which is cheaper than hashing their cells.
   if (auto it = std::find_if(std::begin(cage_list), std::end(cage_list),
-                             [&pseudo_cage](auto const &cage_ptr) {
-                               return cage_ptr->sum == pseudo_cage->sum &&
-                                      cage_ptr->size() == pseudo_cage->size() &&
-                                      cage_ptr->member_set() ==
-                                          pseudo_cage->member_set();
+                             [&pseudo_cage](Cage const *cage) {
+                               return cage->sum == pseudo_cage.sum &&
+                                      cage->size() == pseudo_cage.size() &&
+                                      cage->getCellSet() ==
+                                          pseudo_cage.getCellSet();
                              });
-      it != std::end(cage_list)) {
-    return it->get();
+      it != std::end(cage_list))
+    return *it;
+
+  // Otherwise another region may have.
+  auto [it, inserted] = grid->pseudo_cage_index.try_emplace(
+      pseudo_cage.getPseudoCageKey(), nullptr);
+  if (!inserted) {
+    Cage *the_cage = it->second;
+    // Another region made this cage, perhaps earlier in this same step, so
+    // its combos may not have caught up with the cells' candidates yet.
+    if (the_cage->cage_combos) {
+      CageComboInfo &cage_combos = *the_cage->cage_combos;
+      for (std::size_t i = 0, e = the_cage->size(); i != e; i++)
+        cage_combos.restrictCell(i, (*the_cage)[i]->candidates);
+      cage_combos.eraseCombos([](CageCombo const &cage_combo) {
+        return cage_combo.getPermutations().empty();
+      });
+    }
+    region.addPseudoCage(cage_list, the_cage);
+    return the_cage;
   }
 
-  cage_list.push_back(std::move(pseudo_cage));
-  Cage *the_cage = cage_list.back().get();
+  grid->pseudo_cages.push_back(grid->arena.make<Cage>(pseudo_cage.sum, true));
+  Cage *the_cage = grid->pseudo_cages.back().get();
+  the_cage->cells = pseudo_cage.cells;
+  the_cage->pseudo_name = pseudo_cage.pseudo_name;
+  it->second = the_cage;
 
   if (the_cage->doAllCellsSeeEachOther()) {
-    grid->cage_combos.emplace_back(generateCageComboInfo(the_cage));
+    grid->cage_combos.emplace_back(
+        generateCageComboInfo(grid->arena, the_cage));
     the_cage->cage_combos = grid->cage_combos.back().get();
-  } else if (the_cage->size() < 7) {
-    // FIXME: The solver gets really slow if we do this for all large clashing
-    // cages. How can we be smarter?
+  } else {
     std::vector<Mask> possibles;
     possibles.reserve(the_cage->cells.size());
     for (auto const *cell : the_cage->cells)
       possibles.push_back(cell->candidates);
 
     std::vector<CellMask> clashes = the_cage->getCellClashMasks();
-    auto cage_combos =
-        generateSubsetSumsWithDuplicates(the_cage->sum, possibles, clashes);
-    grid->cage_combos.emplace_back(
-        std::make_unique<CageComboInfo>(the_cage, std::move(cage_combos)));
-    the_cage->cage_combos = grid->cage_combos.back().get();
+    // Searching every permutation gets really slow for large clashing cages,
+    // so build those up from the groups of cells which see each other
+    // instead. Even then, a cage with too many permutations costs the steps
+    // using its combos more than it's worth, so leave it without.
+    std::optional<std::vector<CageCombo>> cage_combos;
+    if (the_cage->size() < 7) {
+      cage_combos =
+          generateSubsetSumsWithDuplicates(the_cage->sum, possibles, clashes);
+    } else {
+      the_cage->is_large_clashing = true;
+      cage_combos = generateClashingCageCombos(the_cage->sum, possibles,
+                                               clashes, MaxPseudoCagePerms);
+    }
+    if (cage_combos) {
+      grid->cage_combos.emplace_back(grid->arena.make<CageComboInfo>(
+          the_cage, std::move(*cage_combos)));
+      the_cage->cage_combos = grid->cage_combos.back().get();
+    }
   }
 
   // Finally, register this cage with all of its component cells.
-  for (auto *c : *the_cage)
-    c->pseudo_cages.push_back(the_cage);
+  region.addPseudoCage(cage_list, the_cage);
 
   return the_cage;
 }
@@ -1,11 +1,10 @@
 #include "intersections.h"
 #include <algorithm>
 
-bool EliminatePointingPairsOrTriplesStep::runOnRowOrCol(House &house,
-                                                        HouseArray &boxes,
-                                                        bool debug) {
+bool EliminatePointingPairsOrTriplesStep::runOnRowOrCol(
+    House &house, CellCountMaskArray const &cell_masks, HouseArray &boxes,
+    bool debug) {
   bool modified = false;
-  CellCountMaskArray cell_masks = collectCellCountMaskInfo(house);
 
   for (unsigned i = 0, e = cell_masks.size(); i < e; ++i) {
     const Mask cell_mask = cell_masks[i];
@@ -78,11 +77,10 @@ bool EliminatePointingPairsOrTriplesStep::runOnRowOrCol(House &house,
   return modified;
 }
 
-bool EliminatePointingPairsOrTriplesStep::runOnBox(House &box, HouseArray &rows,
-                                                   HouseArray &cols,
-                                                   bool debug) {
+bool EliminatePointingPairsOrTriplesStep::runOnBox(
+    House &box, CellCountMaskArray const &cell_masks, HouseArray &rows,
+    HouseArray &cols, bool debug) {
   bool modified = false;
-  CellCountMaskArray cell_masks = collectCellCountMaskInfo(box);
 
   for (unsigned i = 0, e = cell_masks.size(); i < e; ++i) {
     const Mask cell_mask = cell_masks[i];
@@ -11,14 +11,22 @@ struct EliminatePointingPairsOrTriplesStep : ColumboStep {
     changed.clear();
     bool modified = false;
     bool debug = dbg_opts.debug(getID());
-    for (auto &row : grid->rows) {
-      modified |= runOnRowOrCol(*row, grid->boxes, debug);
-    }
-    for (auto &col : grid->cols) {
-      modified |= runOnRowOrCol(*col, grid->boxes, debug);
-    }
-    for (auto &box : grid->boxes) {
-      modified |= runOnBox(*box, grid->rows, grid->cols, debug);
+    HouseCellCountMasks house_masks =
+        collectHouseCellCountMasks(grid->candidates);
+    // Rows and columns come first, then boxes.
+    for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++) {
+      House &house = *grid->getHouse(house_idx);
+      CellCountMaskArray const &cell_masks = house_masks[house_idx];
+      bool house_modified;
+      if (house.getKind() == HouseKind::Box)
+        house_modified =
+            runOnBox(house, cell_masks, grid->rows, grid->cols, debug);
+      else
+        house_modified = runOnRowOrCol(house, cell_masks, grid->boxes, debug);
+      if (house_modified) {
+        modified = true;
+        house_masks = collectHouseCellCountMasks(grid->candidates);
+      }
     }
     return modified;
   }
@@ -29,8 +37,10 @@ struct EliminatePointingPairsOrTriplesStep : ColumboStep {
   const char *getName() const override { return "Pointing Pairs/Triples"; }
 
 private:
-  bool runOnRowOrCol(House &house, HouseArray &boxes, bool debug);
-  bool runOnBox(House &box, HouseArray &rows, HouseArray &cols, bool debug);
+  bool runOnRowOrCol(House &house, CellCountMaskArray const &cell_masks,
+                     HouseArray &boxes, bool debug);
+  bool runOnBox(House &box, CellCountMaskArray const &cell_masks,
+                HouseArray &rows, HouseArray &cols, bool debug);
 };
 
 #endif // COLUMBO_INTERSECTIONS_H
@@ -56,7 +56,7 @@ bool EliminateImpossibleCombosStep::runOnCage(Cage &cage, bool debug,
 
     modified = true;
     cell->candidates = new_cands;
-    changed.insert(cell);
+    changed.insert(cell->getIndex());
   }
 
   return modified;
@@ -80,8 +80,7 @@ bool EliminateConflictingCombosStep::runOnHouse(House &house, bool debug) {
 
     auto &cage_combos = *cage->cage_combos;
 
-    std::unordered_set<Mask> unique_combos =
-        cage_combos.getUniqueCombinationsIn(house);
+    MaskSet unique_combos = cage_combos.getUniqueCombinationsIn(house);
 
     for (auto *other_cell : house.cells) {
       if (cage->contains(other_cell))
@@ -92,10 +91,10 @@ bool EliminateConflictingCombosStep::runOnHouse(House &house, bool debug) {
       if (std::all_of(
               std::begin(cage->cells), std::end(cage->cells),
               [other_cell](const Cell *c) { return c->canSee(other_cell); }))
-        for (auto const &combo_mask : unique_combos)
-          if ((combo_mask & other_cell->candidates) == other_cell->candidates)
-            invalid_subsets[combo_mask] = {other_cell->candidates,
-                                           CellCageUnit{other_cell}};
+        for (Mask combo_mask :
+             unique_combos.supersetsOf(other_cell->candidates))
+          invalid_subsets[combo_mask] = {other_cell->candidates,
+                                         CellCageUnit{other_cell}};
 
       // Else, try and determine a set of combinations that this other cell's
       // cage must have. For instance, we know that 14/2 must be {48|59} so
@@ -119,9 +118,8 @@ bool EliminateConflictingCombosStep::runOnHouse(House &house, bool debug) {
 
           for (auto m : other_cage->cage_combos->computeKillerPairs(
                    static_cast<unsigned>(cage->size()), cage_cell_mask)) {
-            for (auto &unique : unique_combos)
-              if ((unique & m) == m)
-                invalid_subsets[unique] = {m, CellCageUnit{other_cage}};
+            for (Mask unique : unique_combos.supersetsOf(m))
+              invalid_subsets[unique] = {m, CellCageUnit{other_cage}};
           }
         }
       }
@@ -131,11 +129,10 @@ bool EliminateConflictingCombosStep::runOnHouse(House &house, bool debug) {
       continue;
 
     for (auto &[invalid, conflict_data] : invalid_subsets) {
-      size_t prev_size = cage_combos.size();
-      cage_combos.eraseCombos([inv = invalid](CageCombo const &combo) {
-        return combo.duplicates.none() && combo.combo == inv;
-      });
-      if (prev_size != cage_combos.size()) {
+      // Only the values matter, whether or not the combo repeats any.
+      if (cage_combos.eraseCombos([inv = invalid](CageCombo const &combo) {
+            return combo.combo == inv;
+          })) {
         if (debug) {
           const auto &[conflict_mask, conflict_unit] = conflict_data;
           dbgs() << "Conflicting Combos: cage " << *cage << " combination "
@@ -157,14 +154,13 @@ bool EliminateConflictingCombosStep::runOnHouse(House &house, bool debug) {
 // For the given combo_mask, check all of the cage's permutations containing
 // the value overlap_candidate in the cage cell marked by overlapping_cell_idx,
 // to see whether the combination specified by combo_mask is invalid.
-static std::vector<IntList> getPermutationClashes(Mask combo_mask,
-                                                  Cage const *cage,
-                                                  CellMask cage_mask,
-                                                  unsigned overlapping_cell_idx,
-                                                  unsigned overlap_candidate) {
-  std::vector<IntList> clashes;
+static std::vector<Permutation>
+getPermutationClashes(Mask combo_mask, Cage const *cage, CellMask cage_mask,
+                      unsigned overlapping_cell_idx,
+                      unsigned overlap_candidate) {
+  std::vector<Permutation> clashes;
   for (auto const &cage_combo : *cage->cage_combos) {
-    for (auto const &other_perm : cage_combo.getPermutations()) {
+    for (Permutation other_perm : cage_combo.getPermutations()) {
       // Only check permutations where the overlapping cell has the same value.
       if (other_perm[overlapping_cell_idx] != overlap_candidate)
         continue;
@@ -195,7 +191,8 @@ bool EliminateHardConflictingCombosStep::runOnHouse(House &house, bool debug) {
   std::vector<Cage *> cage_list;
   for (auto *cell : house.cells)
     for (auto *pcage : cell->all_cages())
-      if (pcage->cage_combos && visited.insert(pcage).second)
+      if (pcage->cage_combos && !pcage->is_large_clashing &&
+          visited.insert(pcage).second)
         cage_list.push_back(pcage);
 
   for (auto *cage : cage_list) {
@@ -206,6 +203,7 @@ bool EliminateHardConflictingCombosStep::runOnHouse(House &house, bool debug) {
     for (auto *cell : *cage) {
       for (auto *other_cage : cell->all_cages()) {
         if (cage == other_cage || !other_cage->cage_combos ||
+            other_cage->is_large_clashing ||
             !other_visited.insert(other_cage).second)
           continue;
 
@@ -269,13 +267,18 @@ bool EliminateHardConflictingCombosStep::runOnHouse(House &house, bool debug) {
         unsigned overlap_other_cell_idx = *other_cage->indexOf(overlaps[0]);
 
         // Check each cage combination
-        for (auto &cage_combo : *cage->cage_combos) {
+        CageComboInfo &cage_combos = *cage->cage_combos;
+        for (std::size_t combo_idx = 0; combo_idx < cage_combos.size();
+             combo_idx++) {
+          CageCombo const &cage_combo = cage_combos.getCombos()[combo_idx];
           std::stringstream ss;
           auto &permutations = cage_combo.getPermutations();
           // And manually check each permutation for ones which clash/overlap
           // with the other cage's permutations for the same values.
-          for (unsigned p = 0, pe = permutations.size(); p != pe; p++) {
-            auto const &permutation = permutations[p];
+          std::size_t p = 0;
+          for (auto it = std::begin(permutations), e = std::end(permutations);
+               it != e; ++it, p++) {
+            Permutation permutation = *it;
             Mask combo_mask =
                 CageCombo::comboMaskFromPermuation(permutation, cage_cell_mask);
             auto clashes = getPermutationClashes(
@@ -318,7 +321,8 @@ bool EliminateHardConflictingCombosStep::runOnHouse(House &house, bool debug) {
           }
           // First whittle down the permutations, then see if we can elimiate
           // cell candidates accordingly.
-          cage_combo.erasePermutationsByIndex(invalid_permutation_indices);
+          cage_combos.erasePermutationsByIndex(combo_idx,
+                                               invalid_permutation_indices);
           // Now see if this eliminates cell candidates.
           modified |=
               runOnCage(*cage, debug, "After removing this combination:\n");
@@ -36,15 +36,18 @@ struct EliminateConflictingCombosStep : public EliminateImpossibleCombosStep {
     changed.clear();
     bool modified = false;
     bool debug = dbg_opts.debug(getID());
-    for (auto &row : grid->rows)
-      modified |= runOnHouse(*row, debug);
-    for (auto &col : grid->cols)
-      modified |= runOnHouse(*col, debug);
-    for (auto &box : grid->boxes)
-      modified |= runOnHouse(*box, debug);
+    const HouseMask houses = getChangedHouses(grid);
+    for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++) {
+      if (!houses[house_idx])
+        continue;
+      modified |= runOnHouse(*grid->getHouse(house_idx), debug);
+      markSeen(grid, house_idx);
+    }
     return modified;
   }
 
+  StepScope getScope() const override { return StepScope::HouseCages; }
+
   virtual void anchor() override;
 
   const char *getID() const override { return "conflicting-combos"; }
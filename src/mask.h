@@ -0,0 +1,152 @@
+#ifndef COLUMBO_MASK_H
+#define COLUMBO_MASK_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+
+// A set of the values 1-9, e.g. a cell's candidates or a cage combination.
+// Value N is held in bit N-1. This follows the std::bitset<9> interface it
+// replaces, but is a plain 16-bit integer so is cheap to copy and can answer
+// count/min/max queries with a single instruction.
+class Mask {
+public:
+  static constexpr uint16_t AllBits = 0x1FF;
+
+  constexpr Mask() = default;
+  constexpr Mask(unsigned long val) : bits(val & AllBits) {}
+
+  // Iterates over the indices of the set bits, lowest first.
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = unsigned;
+    using difference_type = std::ptrdiff_t;
+    using pointer = unsigned const *;
+    using reference = unsigned;
+
+    constexpr explicit iterator(uint16_t bits) : bits(bits) {}
+
+    constexpr unsigned operator*() const {
+      return static_cast<unsigned>(__builtin_ctz(bits));
+    }
+    constexpr iterator &operator++() {
+      bits &= bits - 1;
+      return *this;
+    }
+    constexpr iterator operator++(int) {
+      iterator it = *this;
+      ++*this;
+      return it;
+    }
+    constexpr bool operator==(iterator const &other) const {
+      return bits == other.bits;
+    }
+    constexpr bool operator!=(iterator const &other) const {
+      return bits != other.bits;
+    }
+
+  private:
+    uint16_t bits;
+  };
+
+  constexpr iterator begin() const { return iterator{bits}; }
+  constexpr iterator end() const { return iterator{0}; }
+
+  static constexpr std::size_t size() { return 9; }
+
+  constexpr bool operator[](std::size_t i) const { return (bits >> i) & 1; }
+  constexpr bool test(std::size_t i) const { return (*this)[i]; }
+
+  constexpr std::size_t count() const {
+    return static_cast<std::size_t>(__builtin_popcount(bits));
+  }
+  constexpr bool any() const { return bits != 0; }
+  constexpr bool none() const { return bits == 0; }
+  constexpr bool all() const { return bits == AllBits; }
+
+  // True if exactly one bit is set.
+  constexpr bool hasSingleBit() const { return bits && !(bits & (bits - 1)); }
+
+  // Index of the lowest/highest set bit. The mask must not be empty.
+  constexpr unsigned first() const {
+    assert(any() && "Unset mask");
+    return static_cast<unsigned>(__builtin_ctz(bits));
+  }
+  constexpr unsigned last() const {
+    assert(any() && "Unset mask");
+    return static_cast<unsigned>(31 - __builtin_clz(bits));
+  }
+
+  constexpr Mask &set() {
+    bits = AllBits;
+    return *this;
+  }
+  constexpr Mask &set(std::size_t i, bool val = true) {
+    assert(i < size() && "Bit out of range");
+    bits = static_cast<uint16_t>(val ? bits | (1u << i) : bits & ~(1u << i));
+    return *this;
+  }
+  constexpr Mask &reset() {
+    bits = 0;
+    return *this;
+  }
+  constexpr Mask &reset(std::size_t i) { return set(i, false); }
+  constexpr Mask &flip() {
+    bits ^= AllBits;
+    return *this;
+  }
+  constexpr Mask &flip(std::size_t i) { return set(i, !test(i)); }
+
+  constexpr unsigned long to_ulong() const { return bits; }
+
+  constexpr Mask operator~() const { return Mask(~bits & AllBits); }
+
+  constexpr Mask &operator&=(Mask other) {
+    bits &= other.bits;
+    return *this;
+  }
+  constexpr Mask &operator|=(Mask other) {
+    bits |= other.bits;
+    return *this;
+  }
+  constexpr Mask &operator^=(Mask other) {
+    bits ^= other.bits;
+    return *this;
+  }
+
+  friend constexpr Mask operator&(Mask lhs, Mask rhs) { return lhs &= rhs; }
+  friend constexpr Mask operator|(Mask lhs, Mask rhs) { return lhs |= rhs; }
+  friend constexpr Mask operator^(Mask lhs, Mask rhs) { return lhs ^= rhs; }
+
+  friend constexpr bool operator==(Mask lhs, Mask rhs) {
+    return lhs.bits == rhs.bits;
+  }
+  friend constexpr bool operator!=(Mask lhs, Mask rhs) {
+    return lhs.bits != rhs.bits;
+  }
+
+private:
+  uint16_t bits = 0;
+};
+
+// The largest and smallest values in a mask. The mask must not be empty, but
+// 0 is returned if it is.
+inline unsigned max_value(Mask m) {
+  assert(m.any() && "Unset mask");
+  return m.none() ? 0 : m.last() + 1;
+}
+inline unsigned min_value(Mask m) {
+  assert(m.any() && "Unset mask");
+  return m.none() ? 0 : m.first() + 1;
+}
+
+namespace std {
+template <> struct hash<Mask> {
+  std::size_t operator()(Mask m) const noexcept { return m.to_ulong(); }
+};
+} // namespace std
+
+#endif // COLUMBO_MASK_H
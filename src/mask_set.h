@@ -0,0 +1,215 @@
+#ifndef COLUMBO_MASK_SET_H
+#define COLUMBO_MASK_SET_H
+
+#include "mask.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+
+// A set of Masks, e.g. the value combinations a cage may take. There are only
+// 512 masks, so the set is a 512-bit bitmap with mask M held in bit M. Sets
+// are cheap to copy and combine, and iterate in increasing mask order.
+class MaskSet {
+public:
+  static constexpr unsigned NumWords = (Mask::AllBits + 1) / 64;
+
+  constexpr MaskSet() = default;
+  constexpr MaskSet(std::initializer_list<Mask> masks) {
+    for (Mask m : masks)
+      insert(m);
+  }
+
+  // Iterates over the masks in the set, lowest first.
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Mask;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Mask const *;
+    using reference = Mask;
+
+    constexpr iterator(MaskSet const *set, unsigned word, uint64_t bits)
+        : set(set), word(word), bits(bits) {
+      skipEmptyWords();
+    }
+
+    constexpr Mask operator*() const {
+      return Mask(word * 64 + static_cast<unsigned>(__builtin_ctzll(bits)));
+    }
+    constexpr iterator &operator++() {
+      bits &= bits - 1;
+      skipEmptyWords();
+      return *this;
+    }
+    constexpr iterator operator++(int) {
+      iterator it = *this;
+      ++*this;
+      return it;
+    }
+    constexpr bool operator==(iterator const &other) const {
+      return word == other.word && bits == other.bits;
+    }
+    constexpr bool operator!=(iterator const &other) const {
+      return !(*this == other);
+    }
+
+  private:
+    MaskSet const *set;
+    unsigned word;
+    uint64_t bits;
+
+    constexpr void skipEmptyWords() {
+      while (!bits && word + 1 < NumWords)
+        bits = set->words[++word];
+    }
+  };
+
+  constexpr iterator begin() const { return iterator{this, 0, words[0]}; }
+  constexpr iterator end() const { return iterator{this, NumWords - 1, 0}; }
+
+  constexpr bool contains(Mask m) const {
+    return (words[m.to_ulong() / 64] >> (m.to_ulong() % 64)) & 1;
+  }
+  constexpr std::size_t size() const {
+    std::size_t n = 0;
+    for (uint64_t w : words)
+      n += static_cast<std::size_t>(__builtin_popcountll(w));
+    return n;
+  }
+  constexpr bool empty() const {
+    uint64_t any = 0;
+    for (uint64_t w : words)
+      any |= w;
+    return !any;
+  }
+  constexpr bool any() const { return !empty(); }
+
+  constexpr void insert(Mask m) {
+    words[m.to_ulong() / 64] |= uint64_t{1} << (m.to_ulong() % 64);
+  }
+  constexpr void erase(Mask m) {
+    words[m.to_ulong() / 64] &= ~(uint64_t{1} << (m.to_ulong() % 64));
+  }
+  constexpr void clear() { words = {}; }
+
+  constexpr MaskSet &operator&=(MaskSet const &other) {
+    for (unsigned w = 0; w < NumWords; w++)
+      words[w] &= other.words[w];
+    return *this;
+  }
+  constexpr MaskSet &operator|=(MaskSet const &other) {
+    for (unsigned w = 0; w < NumWords; w++)
+      words[w] |= other.words[w];
+    return *this;
+  }
+
+  friend constexpr MaskSet operator&(MaskSet lhs, MaskSet const &rhs) {
+    return lhs &= rhs;
+  }
+  friend constexpr MaskSet operator|(MaskSet lhs, MaskSet const &rhs) {
+    return lhs |= rhs;
+  }
+
+  friend constexpr bool operator==(MaskSet const &lhs, MaskSet const &rhs) {
+    for (unsigned w = 0; w < NumWords; w++)
+      if (lhs.words[w] != rhs.words[w])
+        return false;
+    return true;
+  }
+  friend constexpr bool operator!=(MaskSet const &lhs, MaskSet const &rhs) {
+    return !(lhs == rhs);
+  }
+
+  // Every mask which isn't in the set.
+  constexpr MaskSet operator~() const {
+    MaskSet set;
+    for (unsigned w = 0; w < NumWords; w++)
+      set.words[w] = ~words[w];
+    return set;
+  }
+
+  // The complement of each mask in the set. As mask M is held in bit M, this
+  // reverses the bitmap.
+  constexpr MaskSet complements() const {
+    MaskSet set;
+    for (unsigned w = 0; w < NumWords; w++)
+      set.words[w] = reverseBits(words[NumWords - 1 - w]);
+    return set;
+  }
+
+  // The masks in the set which lack the value with index i, with it added.
+  constexpr MaskSet withValueAdded(unsigned i) const;
+
+  // The masks in the set which contain all of m's values.
+  constexpr MaskSet supersetsOf(Mask m) const;
+  constexpr bool anySupersetOf(Mask m) const {
+    return supersetsOf(m).any();
+  }
+
+  // The values which every mask in the set contains; all values if the set is
+  // empty.
+  constexpr Mask common() const;
+
+private:
+  std::array<uint64_t, NumWords> words = {};
+
+  static constexpr uint64_t reverseBits(uint64_t x) {
+    x = (x >> 1 & 0x5555555555555555ull) | (x & 0x5555555555555555ull) << 1;
+    x = (x >> 2 & 0x3333333333333333ull) | (x & 0x3333333333333333ull) << 2;
+    x = (x >> 4 & 0x0F0F0F0F0F0F0F0Full) | (x & 0x0F0F0F0F0F0F0F0Full) << 4;
+    x = (x >> 8 & 0x00FF00FF00FF00FFull) | (x & 0x00FF00FF00FF00FFull) << 8;
+    x = (x >> 16 & 0x0000FFFF0000FFFFull) | (x & 0x0000FFFF0000FFFFull) << 16;
+    return x >> 32 | x << 32;
+  }
+
+  // Moves each mask M to M + n, dropping those which go past the last mask.
+  constexpr MaskSet shiftedUp(unsigned n) const {
+    MaskSet set;
+    const unsigned shift_words = n / 64, shift_bits = n % 64;
+    for (unsigned w = NumWords; w-- > shift_words;) {
+      const unsigned from = w - shift_words;
+      set.words[w] = words[from] << shift_bits;
+      if (shift_bits && from > 0)
+        set.words[w] |= words[from - 1] >> (64 - shift_bits);
+    }
+    return set;
+  }
+};
+
+// For each value, the set of masks containing it.
+inline constexpr std::array<MaskSet, 9> MasksWithValue = [] {
+  std::array<MaskSet, 9> sets{};
+  for (unsigned bits = 0; bits <= Mask::AllBits; bits++)
+    for (unsigned i = 0; i < 9; i++)
+      if (bits & (1u << i))
+        sets[i].insert(Mask(bits));
+  return sets;
+}();
+
+constexpr MaskSet MaskSet::withValueAdded(unsigned i) const {
+  return (*this & ~MasksWithValue[i]).shiftedUp(1u << i);
+}
+
+constexpr MaskSet MaskSet::supersetsOf(Mask m) const {
+  MaskSet set = *this;
+  for (unsigned i : m)
+    set &= MasksWithValue[i];
+  return set;
+}
+
+constexpr Mask MaskSet::common() const {
+  Mask m;
+  for (unsigned i = 0; i < 9; i++) {
+    uint64_t missing = 0;
+    for (unsigned w = 0; w < NumWords; w++)
+      missing |= words[w] & ~MasksWithValue[i].words[w];
+    if (!missing)
+      m.set(i);
+  }
+  return m;
+}
+
+#endif // COLUMBO_MASK_SET_H
@@ -2,6 +2,7 @@
 #define COLUMBO_PRINTABLE_H
 
 #include <functional>
+#include <ostream>
 
 class Printable {
 public:
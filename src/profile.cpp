@@ -0,0 +1,97 @@
+#include "profile.h"
+
+#include <algorithm>
+#include <cmath>
+
+static double getBucketLimitMs(unsigned bucket) {
+  return StepProfile::MinBucketMs *
+         std::exp2(static_cast<double>(bucket) /
+                   StepProfile::BucketsPerDoubling);
+}
+
+void StepProfile::recordTime(double time_ms) {
+  num_runs++;
+  total_ms += time_ms;
+  max_ms = std::max(max_ms, time_ms);
+  unsigned bucket = 0;
+  if (time_ms >= MinBucketMs)
+    bucket = std::min(
+        NumBuckets - 1,
+        1 + static_cast<unsigned>(std::log2(time_ms / MinBucketMs) *
+                                  BucketsPerDoubling));
+  time_buckets[bucket]++;
+}
+
+void StepProfile::merge(StepProfile const &other) {
+  num_runs += other.num_runs;
+  num_useful += other.num_useful;
+  num_cells_changed += other.num_cells_changed;
+  num_eliminations += other.num_eliminations;
+  total_ms += other.total_ms;
+  max_ms = std::max(max_ms, other.max_ms);
+  for (unsigned i = 0; i < NumBuckets; i++)
+    time_buckets[i] += other.time_buckets[i];
+}
+
+double StepProfile::getMeanMs() const {
+  return num_runs ? total_ms / num_runs : 0.0;
+}
+
+double StepProfile::getP99Ms() const {
+  if (!num_runs)
+    return 0.0;
+  const unsigned long rank =
+      static_cast<unsigned long>(std::ceil(0.99 * num_runs));
+  unsigned long seen = 0;
+  unsigned bucket = 0;
+  while ((seen += time_buckets[bucket]) < rank)
+    bucket++;
+  // No run took longer than the slowest, whatever its bucket's limit. The
+  // last bucket also counts every run past its limit.
+  if (bucket == NumBuckets - 1)
+    return max_ms;
+  return std::min(getBucketLimitMs(bucket), max_ms);
+}
+
+void Profile::recordRun(const char *id, double time_ms,
+                        unsigned long num_cells_changed,
+                        unsigned long num_eliminations) {
+  StepProfile &step = steps[id];
+  step.num_useful += num_cells_changed != 0;
+  step.num_cells_changed += num_cells_changed;
+  step.num_eliminations += num_eliminations;
+  step.recordTime(time_ms);
+}
+
+void Profile::merge(Profile const &other) {
+  for (auto const &[id, other_step] : other.steps)
+    steps[id].merge(other_step);
+}
+
+void Profile::write(std::ostream &os, ProfileFormat format) const {
+  if (format == ProfileFormat::CSV) {
+    os << "step,runs,useful,cells_changed,candidates_removed,total_ms,mean_ms,"
+          "p99_ms\n";
+    for (auto const &[id, step] : steps)
+      os << id << ',' << step.num_runs << ',' << step.num_useful << ','
+         << step.num_cells_changed << ',' << step.num_eliminations << ','
+         << step.getTotalMs() << ',' << step.getMeanMs() << ','
+         << step.getP99Ms() << '\n';
+    return;
+  }
+
+  os << "{\n  \"steps\": [";
+  bool sep = false;
+  for (auto const &[id, step] : steps) {
+    os << (sep ? ",\n" : "\n") << "    {\"step\": \"" << id
+       << "\", \"runs\": " << step.num_runs
+       << ", \"useful\": " << step.num_useful
+       << ", \"cells_changed\": " << step.num_cells_changed
+       << ", \"candidates_removed\": " << step.num_eliminations
+       << ", \"total_ms\": " << step.getTotalMs()
+       << ", \"mean_ms\": " << step.getMeanMs()
+       << ", \"p99_ms\": " << step.getP99Ms() << "}";
+    sep = true;
+  }
+  os << "\n  ]\n}\n";
+}
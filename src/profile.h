@@ -0,0 +1,54 @@
+#ifndef COLUMBO_PROFILE_H
+#define COLUMBO_PROFILE_H
+
+#include <array>
+#include <map>
+#include <ostream>
+#include <string>
+
+struct StepProfile {
+  // Run times are counted in log-spaced buckets, so that profiling a large
+  // batch takes constant memory. Bucket 0 counts runs under MinBucketMs, and
+  // bucket i > 0 those under MinBucketMs * 2^(i / BucketsPerDoubling): about
+  // 9% wide, up to several minutes.
+  static constexpr double MinBucketMs = 1.0 / (1 << 14);
+  static constexpr unsigned BucketsPerDoubling = 8;
+  static constexpr unsigned NumBuckets = 256;
+
+  unsigned long num_runs = 0;
+  // The number of runs which changed the grid.
+  unsigned long num_useful = 0;
+  unsigned long num_cells_changed = 0;
+  unsigned long num_eliminations = 0;
+  double total_ms = 0;
+  double max_ms = 0;
+  std::array<unsigned long, NumBuckets> time_buckets = {};
+
+  void recordTime(double time_ms);
+  void merge(StepProfile const &other);
+
+  double getTotalMs() const { return total_ms; }
+  double getMeanMs() const;
+  // The time 99% of runs finished within, to the bucket's precision.
+  double getP99Ms() const;
+};
+
+enum class ProfileFormat { CSV, JSON };
+
+// Timings and counters for each step, aggregated over every grid solved while
+// profiling. Alongside the step IDs, "clean-up-cage-combos" times the
+// clean-up which follows each useful step, and "solve-grid" times whole
+// solves.
+struct Profile {
+  // Keyed by step ID, so that reports always list steps in the same order.
+  std::map<std::string, StepProfile> steps;
+
+  void recordRun(const char *id, double time_ms,
+                 unsigned long num_cells_changed = 0,
+                 unsigned long num_eliminations = 0);
+  void merge(Profile const &other);
+
+  void write(std::ostream &os, ProfileFormat format) const;
+};
+
+#endif // COLUMBO_PROFILE_H
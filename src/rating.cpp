@@ -0,0 +1,109 @@
+#include "rating.h"
+
+#include <iterator>
+#include <numeric>
+
+// How hard each step is to spot. Difficulties are bands of these weights, so
+// the generator and --rate share the one table.
+static const std::pair<const char *, unsigned> StepWeights[] = {
+    {"fixed-cell-cleanup", 0},
+    {"hidden-singles", 1},
+    {"impossible-combos", 1},
+    {"naked-pairs", 2},
+    {"pointing-pairs-triples", 2},
+    {"innies-outies", 3},
+    {"conflicting-combos", 3},
+    {"naked-triples", 3},
+    {"hidden-pairs", 3},
+    {"cage-unit-overlap", 3},
+    {"hidden-triples", 4},
+    {"hidden-quads", 5},
+    {"naked-quads", 5},
+    {"x-wings", 5},
+    {"naked-quints", 6},
+    {"innies-outies-hard", 6},
+    {"cage-unit-overlap-hard", 6},
+    {"conflicting-combos-hard", 7},
+    {"search", 10},
+};
+
+// The lowest step weight of each difficulty after Easy.
+static const unsigned DifficultyWeights[] = {3, 4, 6, 10};
+
+static const char *const DifficultyNames[] = {"easy", "moderate", "hard",
+                                              "expert", "search"};
+
+unsigned getStepWeight(std::string_view id) {
+  for (auto const &[step_id, weight] : StepWeights)
+    if (id == step_id)
+      return weight;
+  return 0;
+}
+
+Difficulty getStepDifficulty(std::string_view id) {
+  const unsigned weight = getStepWeight(id);
+  unsigned i = 0;
+  while (i < std::size(DifficultyWeights) && weight >= DifficultyWeights[i])
+    i++;
+  return static_cast<Difficulty>(i);
+}
+
+const char *getDifficultyName(Difficulty difficulty) {
+  return DifficultyNames[static_cast<unsigned>(difficulty)];
+}
+
+std::optional<Difficulty> parseDifficulty(std::string_view name) {
+  for (unsigned i = 0; i < NumDifficulties; i++)
+    if (name == DifficultyNames[i])
+      return static_cast<Difficulty>(i);
+  return std::nullopt;
+}
+
+unsigned countCandidates(CandidateArray const &candidates) {
+  return std::accumulate(
+      std::begin(candidates), std::end(candidates), 0u,
+      [](unsigned total, Mask m) { return total + m.count(); });
+}
+
+void Rating::recordStep(const char *id, unsigned num_eliminations) {
+  StepUsage &usage = steps[id];
+  usage.num_useful++;
+  usage.num_eliminations += num_eliminations;
+}
+
+void Rating::recordSearch() { steps["search"].num_useful++; }
+
+const char *Rating::getHardestStep() const {
+  const char *hardest = nullptr;
+  unsigned hardest_weight = 0;
+  for (auto const &[id, usage] : steps) {
+    const unsigned weight = getStepWeight(id);
+    if (!hardest || weight > hardest_weight) {
+      hardest = id.c_str();
+      hardest_weight = weight;
+    }
+  }
+  return hardest;
+}
+
+unsigned Rating::getScore() const {
+  unsigned score = 0;
+  for (auto const &[id, usage] : steps)
+    score += getStepWeight(id) * usage.num_useful;
+  if (const char *hardest = getHardestStep())
+    score += 10 * getStepWeight(hardest);
+  return score;
+}
+
+Difficulty Rating::getDifficulty() const {
+  const char *hardest = getHardestStep();
+  return hardest ? getStepDifficulty(hardest) : Difficulty::Easy;
+}
+
+Printable printRating(Rating const &rating) {
+  return Printable([&rating](std::ostream &os) {
+    const char *hardest = rating.getHardestStep();
+    os << rating.getScore() << ' ' << getDifficultyName(rating.getDifficulty())
+       << " (" << (hardest ? hardest : "none") << ")";
+  });
+}
@@ -0,0 +1,60 @@
+#ifndef COLUMBO_RATING_H
+#define COLUMBO_RATING_H
+
+#include "defs.h"
+#include "printable.h"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// How hard a grid is to solve, by the weight of the hardest step it needs.
+// Grids which need searching are beyond every step.
+enum class Difficulty { Easy, Moderate, Hard, Expert, Search };
+
+static constexpr unsigned NumDifficulties =
+    static_cast<unsigned>(Difficulty::Search) + 1;
+
+const char *getDifficultyName(Difficulty difficulty);
+std::optional<Difficulty> parseDifficulty(std::string_view name);
+
+struct StepUsage {
+  // The number of times the step made progress.
+  unsigned num_useful = 0;
+  // The number of candidates it eliminated across those times.
+  unsigned num_eliminations = 0;
+};
+
+// Records the steps a grid needed to be solved, and rates its difficulty from
+// them. Each step ID has a weight for how hard the technique is to spot; the
+// score is ten times the weight of the hardest step used, plus each step's
+// weight for every time it made progress. A grid which needed searching is
+// rated as though 'search' were a step used once.
+struct Rating {
+  // Keyed by step ID. Ordered so that the rating prints the same every time.
+  std::map<std::string, StepUsage> steps;
+
+  void recordStep(const char *id, unsigned num_eliminations);
+  void recordSearch();
+
+  // The ID of the hardest step used, or nullptr if none made progress.
+  const char *getHardestStep() const;
+  unsigned getScore() const;
+  // The difficulty of the hardest step used.
+  Difficulty getDifficulty() const;
+};
+
+// How hard the step with the given ID is to spot, from 0 for bookkeeping
+// steps upwards.
+unsigned getStepWeight(std::string_view id);
+// The difficulty of a grid whose hardest step has the given ID.
+Difficulty getStepDifficulty(std::string_view id);
+
+// The total number of candidates left in the grid.
+unsigned countCandidates(CandidateArray const &candidates);
+
+// Prints e.g. "57 expert (innies-outies-hard)".
+Printable printRating(Rating const &rating);
+
+#endif // COLUMBO_RATING_H
@@ -0,0 +1,338 @@
+#include "search.h"
+#include "debug.h"
+#include "exact_cover.h"
+
+using Clock = std::chrono::steady_clock;
+
+SolveDeadline startDeadline(SearchOptions const &opts) {
+  if (!opts.time_limit)
+    return std::nullopt;
+  return Clock::now() + *opts.time_limit;
+}
+
+struct Deadline {
+  SolveDeadline end;
+  unsigned polls = 0;
+  bool expired = false;
+
+  explicit Deadline(SolveDeadline end) : end(end) {}
+
+  bool hasExpired() {
+    if (!expired && end)
+      expired = Clock::now() >= *end;
+    return expired;
+  }
+
+  // Only reads the clock every so often, for loops such as the exact cover
+  // solver's whose iterations cost less than reading it.
+  bool hasExpiredPolled() {
+    if (!expired && end && (++polls % 256) == 0)
+      expired = Clock::now() >= *end;
+    return expired;
+  }
+};
+
+// Whether the grid holds a complete and valid solution.
+static bool isSolution(Grid const *grid) {
+  for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++) {
+    Mask seen = 0;
+    for (unsigned idx : HouseCells[house_idx]) {
+      const Mask cands = grid->candidates[idx];
+      if (!cands.hasSingleBit() || (seen & cands).any())
+        return false;
+      seen |= cands;
+    }
+  }
+
+  for (auto const &cage : grid->cages) {
+    Mask seen = 0;
+    unsigned sum = 0;
+    for (auto const *cell : cage->cells) {
+      if ((seen & cell->candidates).any())
+        return false;
+      seen |= cell->candidates;
+      sum += cell->isFixed();
+    }
+    if (sum != cage->sum)
+      return false;
+  }
+
+  return true;
+}
+
+// The next thing to guess on: either a cell's candidates or a cage's
+// remaining permutations, whichever has fewer options. No options means the
+// grid has reached a dead end.
+struct Branch {
+  Cell *cell = nullptr;
+  Cage *cage = nullptr;
+  std::size_t num_options = 0;
+};
+
+static Branch chooseBranch(Grid *const grid) {
+  Branch best;
+  for (unsigned idx = 0; idx < NumCells; idx++) {
+    const std::size_t count = grid->candidates[idx].count();
+    if (count == 0)
+      return Branch{};
+    if (count > 1 && (!best.num_options || count < best.num_options))
+      best = Branch{grid->getCell(idx), nullptr, count};
+  }
+
+  for (auto &cage : grid->cages) {
+    if (!cage->cage_combos ||
+        std::all_of(std::begin(*cage), std::end(*cage),
+                    [](Cell const *c) { return c->isFixed(); }))
+      continue;
+    std::size_t count = 0;
+    for (auto const &combo : cage->cage_combos->getCombos())
+      count += combo.getPermutations().size();
+    if (count == 0)
+      return Branch{};
+    if (count < best.num_options)
+      best = Branch{nullptr, cage.get(), count};
+  }
+
+  return best;
+}
+
+struct GuessSearcher {
+  Grid *const grid;
+  Strategy &strat;
+  SearchOptions const &opts;
+  DebugOptions const &dbg_opts;
+  Deadline deadline;
+  SearchStats stats;
+
+  GuessSearcher(Grid *const grid, Strategy &strat, SearchOptions const &opts,
+                DebugOptions const &dbg_opts, SolveDeadline end)
+      : grid(grid), strat(strat), opts(opts), dbg_opts(dbg_opts),
+        deadline(end) {}
+
+  // Returns true once enough solutions have been found.
+  bool search();
+  bool foundSolution();
+  bool outOfGuesses() const {
+    return opts.max_guesses && stats.num_guesses >= opts.max_guesses;
+  }
+
+private:
+  bool tryGuess(CellSet &changed);
+};
+
+bool GuessSearcher::foundSolution() {
+  if (!isSolution(grid))
+    return false;
+  stats.num_solutions++;
+  return stats.num_solutions >= opts.max_solutions;
+}
+
+// Propagates a guess which changed the given cells, then carries on
+// searching.
+bool GuessSearcher::tryGuess(CellSet &changed) {
+  if (outOfGuesses()) {
+    deadline.expired = true;
+    return false;
+  }
+  stats.num_guesses++;
+  try {
+    cleanUpCageCombos(grid, changed);
+    strat.resetSteps();
+    Stats propagated = strat.solveGrid(grid, dbg_opts);
+    if (propagated.is_complete)
+      return foundSolution();
+    if (propagated.timed_out) {
+      deadline.expired = true;
+      return false;
+    }
+    return search();
+  } catch (invalid_grid_exception &) {
+    return false;
+  }
+}
+
+bool GuessSearcher::search() {
+  if (deadline.hasExpired())
+    return false;
+
+  Branch branch = chooseBranch(grid);
+  if (!branch.num_options)
+    return false;
+
+  bool debug = dbg_opts.debug("search");
+  GridSnapshot snapshot = grid->snapshot();
+
+  if (branch.cell) {
+    const Mask candidates = branch.cell->candidates;
+    for (unsigned i : candidates) {
+      if (debug)
+        dbgs() << "Search: guessing " << branch.cell->coord << " is " << (i + 1)
+               << "\n";
+      branch.cell->candidates = 1 << i;
+      CellSet changed{branch.cell->getIndex()};
+      if (tryGuess(changed))
+        return true;
+      stats.num_backtracks++;
+      grid->restore(snapshot);
+      if (deadline.expired)
+        return false;
+    }
+    return false;
+  }
+
+  Cage *cage = branch.cage;
+  PermutationList permutations;
+  for (auto const &combo : cage->cage_combos->getCombos())
+    for (Permutation perm : combo.getPermutations())
+      permutations.push_back(perm);
+
+  for (Permutation perm : permutations) {
+    if (debug)
+      dbgs() << "Search: guessing " << *cage << " is "
+             << printIntList(perm) << "\n";
+    CellSet changed;
+    bool is_possible = true;
+    for (std::size_t i = 0, e = cage->size(); i != e && is_possible; i++) {
+      const Mask m = 1 << (perm[i] - 1);
+      is_possible = ((*cage)[i]->candidates & m).any();
+      ColumboStep::updateCell((*cage)[i], m, changed);
+    }
+    if (is_possible && tryGuess(changed))
+      return true;
+    stats.num_backtracks++;
+    grid->restore(snapshot);
+    if (deadline.expired)
+      return false;
+  }
+  return false;
+}
+
+// Encodes the grid as an exact cover problem: every cage must take exactly
+// one of its remaining permutations, and every digit must appear exactly once
+// in every house.
+static SearchStats searchWithDLX(Grid *const grid, SearchOptions const &opts,
+                                 DebugOptions const &dbg_opts,
+                                 SolveDeadline end) {
+  SearchStats stats;
+  Deadline deadline(end);
+
+  const unsigned num_cages = grid->cages.size();
+  ExactCover problem(num_cages + NumHouses * 9);
+
+  std::vector<std::pair<Cage *, Permutation>> options;
+  std::vector<unsigned> items;
+  for (unsigned k = 0; k < num_cages; k++) {
+    Cage *cage = grid->cages[k].get();
+    if (!cage->cage_combos)
+      throw invalid_grid_exception{"Cages must have combo information"};
+    for (auto const &combo : cage->cage_combos->getCombos()) {
+      for (Permutation perm : combo.getPermutations()) {
+        items.assign(1, k);
+        bool is_possible = true;
+        for (std::size_t i = 0, e = cage->size(); i != e; i++) {
+          const unsigned digit = perm[i] - 1;
+          Cell const *cell = (*cage)[i];
+          is_possible &= cell->candidates[digit];
+          for (unsigned house_idx : CellHouses[cell->getIndex()])
+            items.push_back(num_cages + house_idx * 9 + digit);
+        }
+        if (!is_possible)
+          continue;
+        problem.addOption(items);
+        options.emplace_back(cage, perm);
+      }
+    }
+  }
+
+  if (dbg_opts.debug("search"))
+    dbgs() << "Search: solving exact cover with " << problem.getNumOptions()
+           << " options\n";
+
+  const CandidateArray saved_candidates = grid->candidates;
+  bool found = false;
+  problem.solve(
+      [&](std::vector<unsigned> const &chosen) {
+        if (++stats.num_solutions < opts.max_solutions)
+          return false;
+        for (unsigned option : chosen) {
+          auto [cage, perm] = options[option];
+          for (std::size_t i = 0, e = cage->size(); i != e; i++)
+            (*cage)[i]->candidates = 1 << (perm[i] - 1);
+        }
+        found = true;
+        return true;
+      },
+      [&]() {
+        if (opts.max_guesses && stats.num_guesses >= opts.max_guesses)
+          deadline.expired = true;
+        stats.num_guesses++;
+        return deadline.hasExpiredPolled();
+      });
+
+  stats.is_complete = found && isSolution(grid);
+  if (!stats.is_complete)
+    grid->candidates = saved_candidates;
+  stats.timed_out = deadline.expired;
+  return stats;
+}
+
+// Large cages can have hundreds of thousands of permutations; past this many
+// the exact cover matrix costs more to build than guessing does to search.
+static constexpr std::size_t MaxExactCoverOptions = 1 << 18;
+
+static std::size_t countPermutations(Grid const *grid) {
+  std::size_t count = 0;
+  for (auto const &cage : grid->cages)
+    if (cage->cage_combos)
+      for (auto const &combo : cage->cage_combos->getCombos())
+        count += combo.getPermutations().size();
+  return count;
+}
+
+SearchStats searchGrid(Grid *const grid, Strategy &strat,
+                       SearchOptions const &opts,
+                       DebugOptions const &dbg_opts) {
+  // A deadline already set on the strategy covers the logical solve that got
+  // stuck as well, so the search only gets what is left of it.
+  const SolveDeadline outer = strat.deadline;
+  const SolveDeadline end = outer ? outer : startDeadline(opts);
+  if (opts.engine == SearchEngine::DLX &&
+      countPermutations(grid) <= MaxExactCoverOptions)
+    return searchWithDLX(grid, opts, dbg_opts, end);
+
+  GuessSearcher searcher(grid, strat, opts, dbg_opts, end);
+  // Each guess is propagated by the strategy, which can take a while, so it
+  // must watch the clock too.
+  strat.deadline = end;
+  searcher.stats.is_complete = searcher.search();
+  searcher.stats.timed_out = searcher.deadline.expired;
+  strat.deadline = outer;
+  strat.resetSteps();
+  return searcher.stats;
+}
+
+SearchStats countSolutions(Grid *const grid, Strategy &strat,
+                           SearchOptions const &opts,
+                           DebugOptions const &dbg_opts) {
+  const SolveDeadline outer = strat.deadline;
+  if (!outer)
+    strat.deadline = startDeadline(opts);
+  strat.resetSteps();
+  try {
+    Stats stats = strat.solveGrid(grid, dbg_opts);
+    if (!stats.is_complete) {
+      SearchStats search_stats = searchGrid(grid, strat, opts, dbg_opts);
+      strat.deadline = outer;
+      return search_stats;
+    }
+  } catch (invalid_grid_exception &) {
+    strat.deadline = outer;
+    return SearchStats{};
+  }
+  strat.deadline = outer;
+
+  SearchStats stats;
+  stats.num_solutions = isSolution(grid) ? 1 : 0;
+  stats.is_complete = stats.num_solutions >= opts.max_solutions;
+  return stats;
+}
@@ -0,0 +1,64 @@
+#ifndef COLUMBO_SEARCH_H
+#define COLUMBO_SEARCH_H
+
+#include "defs.h"
+#include "step.h"
+#include "strategy.h"
+
+#include <chrono>
+#include <optional>
+
+enum class SearchEngine {
+  // Guess on the cell or cage with the fewest options, propagating each guess
+  // with the strategy's logical steps.
+  Guess,
+  // Solve the remaining cage permutations as an exact cover problem.
+  DLX,
+};
+
+struct SearchOptions {
+  SearchEngine engine = SearchEngine::Guess;
+  // Give up after this long, counting the logical steps run before the search
+  // as well as the search itself. No limit if unset.
+  std::optional<std::chrono::milliseconds> time_limit =
+      std::chrono::milliseconds(10000);
+  // Give up after this many guesses, if set. Unlike the time limit, this
+  // always stops the search at the same point, however fast it runs.
+  unsigned max_guesses = 0;
+  // Stop once this many solutions have been found.
+  unsigned max_solutions = 1;
+};
+
+struct SearchStats {
+  unsigned num_guesses = 0;
+  unsigned num_backtracks = 0;
+  unsigned num_solutions = 0;
+
+  bool is_complete = false;
+  // Whether the search ran out of time or guesses before it could finish.
+  bool timed_out = false;
+};
+
+// Starts the clock on a solve: set it as the strategy's deadline before the
+// logical steps run so they and the search share one time limit. Returns
+// nothing if the options have no time limit.
+SolveDeadline startDeadline(SearchOptions const &opts);
+
+// Finishes off a grid which the logical steps got stuck on by searching for
+// solutions. The search is complete once it has found 'max_solutions' of
+// them, the last of which is left in the grid; otherwise the grid is left as
+// it was. A search which runs out of options without timing out has found
+// every solution there is. It stops at the strategy's deadline if one is set,
+// rather than starting its own time limit.
+SearchStats searchGrid(Grid *const grid, Strategy &strat,
+                       SearchOptions const &opts,
+                       DebugOptions const &dbg_opts);
+
+// Counts the solutions to a freshly-initialized grid, up to 'max_solutions',
+// using the strategy's steps to propagate between guesses. The time limit
+// covers the logical solve before the search too.
+SearchStats countSolutions(Grid *const grid, Strategy &strat,
+                           SearchOptions const &opts,
+                           DebugOptions const &dbg_opts);
+
+#endif // COLUMBO_SEARCH_H
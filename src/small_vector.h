@@ -0,0 +1,69 @@
+#ifndef COLUMBO_SMALL_VECTOR_H
+#define COLUMBO_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+// A vector of trivially copyable values which keeps up to N of them inline,
+// only moving out to the heap once it outgrows that.
+template <typename T, std::size_t N> class SmallVector {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  using value_type = T;
+  using iterator = T *;
+  using const_iterator = T const *;
+
+  SmallVector() = default;
+  SmallVector(SmallVector const &) = delete;
+  SmallVector &operator=(SmallVector const &) = delete;
+
+  T *data() { return heap ? heap.get() : local.data(); }
+  T const *data() const { return heap ? heap.get() : local.data(); }
+
+  iterator begin() { return data(); }
+  iterator end() { return data() + count; }
+  const_iterator begin() const { return data(); }
+  const_iterator end() const { return data() + count; }
+
+  std::size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  T &operator[](std::size_t i) { return data()[i]; }
+  T const &operator[](std::size_t i) const { return data()[i]; }
+
+  void push_back(T value) {
+    if (count == capacity)
+      grow();
+    data()[count++] = value;
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    T *items = data();
+    T *pos = items + (first - items);
+    T *tail = std::copy(items + (last - items), items + count, pos);
+    count = static_cast<std::size_t>(tail - items);
+    return pos;
+  }
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  void clear() { count = 0; }
+
+private:
+  std::array<T, N> local;
+  std::unique_ptr<T[]> heap;
+  std::size_t count = 0;
+  std::size_t capacity = N;
+
+  void grow() {
+    auto items = std::make_unique<T[]>(capacity * 2);
+    std::copy(begin(), end(), items.get());
+    heap = std::move(items);
+    capacity *= 2;
+  }
+};
+
+#endif // COLUMBO_SMALL_VECTOR_H
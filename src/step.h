@@ -24,6 +24,17 @@ struct DebugOptions {
   }
 };
 
+// What a step's deductions depend on, so that a scheduler can tell when it is
+// worth running again.
+enum class StepScope {
+  // Anything in the grid.
+  Grid,
+  // The candidates of each house's cells.
+  House,
+  // As above, and the combos of the cages overlapping each house.
+  HouseCages,
+};
+
 struct invalid_grid_exception : public std::exception {
   explicit invalid_grid_exception() {}
   explicit invalid_grid_exception(std::string &&msg) : msg(msg) {}
@@ -52,17 +63,56 @@ struct ColumboStep {
     if (intersection.none() || intersection == cell->candidates) {
       return std::nullopt;
     }
-    changed.insert(cell);
+    changed.insert(cell->getIndex());
     cell->candidates &= mask;
     return intersection;
   }
 
   virtual bool runOnGrid(Grid *const grid, DebugOptions const &dbg_opts) = 0;
 
+  virtual StepScope getScope() const { return StepScope::Grid; }
+
+  // The houses which have changed, as far as this step can tell, since it
+  // last ran on them.
+  HouseMask getChangedHouses(Grid const *grid) const {
+    auto it = grid->step_generations.find(this);
+    if (it == std::end(grid->step_generations))
+      return HouseMask{}.set();
+    HouseMask houses;
+    for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++)
+      houses[house_idx] =
+          it->second[house_idx] != getGeneration(grid, house_idx);
+    return houses;
+  }
+
+  // Records that this step has run on the given house as it is now.
+  void markSeen(Grid *const grid, unsigned house_idx) const {
+    auto [it, inserted] = grid->step_generations.try_emplace(this);
+    if (inserted)
+      it->second.fill(~0u);
+    it->second[house_idx] = getGeneration(grid, house_idx);
+  }
+
+  void markSeen(Grid *const grid) const {
+    for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++)
+      markSeen(grid, house_idx);
+  }
+
   const CellSet &getChanged() const { return changed; }
 
+  // Forgets any state left over from running on a previous grid.
+  virtual void reset() { changed.clear(); }
+
 protected:
   CellSet changed;
+
+private:
+  unsigned getGeneration(Grid const *grid, unsigned house_idx) const {
+    if (getScope() == StepScope::House)
+      return grid->cell_generations[house_idx];
+    return grid->cell_generations[house_idx] +
+           grid->cage_generations[house_idx];
+  }
 };
 
 using StepIDMap = std::map<std::string, ColumboStep *>;
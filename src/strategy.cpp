@@ -5,21 +5,17 @@
 #include <chrono>
 #include <algorithm>
 
-bool TIME = false;
-bool USE_COLOUR = true;
+thread_local bool USE_COLOUR = true;
 
 static bool checkIsGridComplete(Grid *const grid) {
-  return std::all_of(std::begin(grid->rows), std::end(grid->rows),
-                     [](const std::unique_ptr<House> &r) {
-                       return std::all_of(
-                           std::begin(*r), std::end(*r),
-                           [](const Cell *c) { return c->isFixed(); });
-                     });
+  return std::all_of(std::begin(grid->candidates), std::end(grid->candidates),
+                     [](Mask m) { return m.hasSingleBit(); });
 }
 
 // Clean up impossible cage combinations after a step has modified the grid
-static void cleanUpCageCombos(CellSet &changed) {
-  for (auto *cell : changed) {
+void cleanUpCageCombos(Grid *const grid, CellSet const &changed) {
+  for (unsigned idx : changed) {
+    Cell *cell = grid->getCell(idx);
     for (auto *cage : cell->all_cages()) {
       const Mask mask = cell->candidates;
 
@@ -32,10 +28,7 @@ static void cleanUpCageCombos(CellSet &changed) {
       auto &cage_combos = *cage->cage_combos;
       // Remove any subsets that use a number that the cell no longer
       // considers a candidate.
-      for (auto &cage_combo : cage_combos)
-        cage_combo.erasePermutations([&mask, &cell_idx](IntList const &list) {
-          return !mask[list[cell_idx] - 1];
-        });
+      cage_combos.restrictCell(cell_idx, mask);
 
       // Remove any cage combos who have run out of permutations.
       cage_combos.eraseCombos([](CageCombo const &cage_combo) {
@@ -45,8 +38,20 @@ static void cleanUpCageCombos(CellSet &changed) {
   }
 }
 
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+static bool hasPassed(SolveDeadline const &deadline) {
+  return deadline && Clock::now() >= *deadline;
+}
+
 static bool runStep(Grid *grid, ColumboStep *step,
-                    const DebugOptions &dbg_opts) {
+                    const DebugOptions &dbg_opts, Rating *rating,
+                    Profile *profile) {
   // Store the 'before' output to a stringstream as it's not very interesting
   // if the step does nothing.
   std::stringstream ss;
@@ -54,23 +59,38 @@ static bool runStep(Grid *grid, ColumboStep *step,
       dbg_opts.print_before_steps.count(step->getID())) {
     printGrid(grid, ss, USE_COLOUR, /*before*/ true, step->getName());
   }
-  auto start = std::chrono::steady_clock::now();
+  const bool count_eliminations = rating || profile;
+  const unsigned num_candidates =
+      count_eliminations ? countCandidates(grid->candidates) : 0;
+  const Clock::time_point start = profile ? Clock::now() : Clock::time_point{};
+  // Pick up any changes made outside of the steps, e.g. by a guess.
+  grid->updateGenerations();
   bool modified = step->runOnGrid(grid, dbg_opts);
+  const double step_ms = profile ? msSince(start) : 0.0;
 
-  if (TIME) {
-    auto end = std::chrono::steady_clock::now();
-    auto diff_ms =
-        std::chrono::duration<double, std::milli>(end - start).count();
-    std::cout << step->getName() << " took " << diff_ms << "ms...\n";
-  }
-
-  if (!modified)
+  if (!modified) {
+    if (profile)
+      profile->recordRun(step->getID(), step_ms);
     return modified;
+  }
 
   assert(!step->getChanged().empty() && "Expected 'modified' to change cells");
 
-  auto changed = step->getChanged();
-  cleanUpCageCombos(changed);
+  const CellSet changed = step->getChanged();
+  const Clock::time_point clean_up_start =
+      profile ? Clock::now() : Clock::time_point{};
+  cleanUpCageCombos(grid, changed);
+  if (profile)
+    profile->recordRun("clean-up-cage-combos", msSince(clean_up_start));
+
+  const unsigned num_eliminations =
+      count_eliminations ? num_candidates - countCandidates(grid->candidates)
+                         : 0;
+  if (rating)
+    rating->recordStep(step->getID(), num_eliminations);
+  if (profile)
+    profile->recordRun(step->getID(), step_ms, changed.size(),
+                       num_eliminations);
 
   if (dbg_opts.print_before_all ||
       dbg_opts.print_before_steps.count(step->getID())) {
@@ -85,7 +105,65 @@ static bool runStep(Grid *grid, ColumboStep *step,
   return modified;
 }
 
-Stats Block::runOnGrid(Grid *const grid, const DebugOptions &dbg_opts) {
+// Runs the steps in order of cost, as a repeating block does, but only reruns
+// a step once the houses it depends on have changed, and then only on those
+// houses. Once a step makes progress, we go back to the cheapest step with
+// work pending.
+Stats Block::runScheduled(Grid *const grid, const DebugOptions &dbg_opts,
+                          Rating *rating, Profile *profile,
+                          SolveDeadline deadline) {
+  Stats stats;
+  auto cleanup_step = std::make_unique<PropagateFixedCells>();
+  grid->updateGenerations();
+
+  for (int i = 0; i <= repeat_count.value_or(0); i++) {
+    if (hasPassed(deadline)) {
+      stats.timed_out = true;
+      break;
+    }
+
+    auto it = std::find_if(std::begin(steps), std::end(steps),
+                           [grid](ColumboStep const *step) {
+                             return step->getChangedHouses(grid).any();
+                           });
+    if (it == std::end(steps))
+      break;
+
+    ColumboStep *step = *it;
+    // Steps which look at the whole grid can only be rerun in full.
+    if (step->getScope() == StepScope::Grid)
+      step->markSeen(grid);
+    stats.modified |= runStep(grid, step, dbg_opts, rating, profile);
+    stats.num_steps++;
+    grid->updateGenerations();
+
+    if (step->getChanged().empty()) {
+      // Only progress counts against the repeat count.
+      i--;
+      continue;
+    }
+
+    stats.num_useful_steps++;
+
+    cleanup_step->setWorkList(step->getChanged());
+    stats.modified |=
+        runStep(grid, cleanup_step.get(), dbg_opts, rating, profile);
+    grid->updateGenerations();
+
+    if (checkIsGridComplete(grid))
+      break;
+  }
+
+  stats.is_complete = checkIsGridComplete(grid);
+  return stats;
+}
+
+Stats Block::runOnGrid(Grid *const grid, const DebugOptions &dbg_opts,
+                       Rating *rating, Profile *profile,
+                       SolveDeadline deadline) {
+  if (blocks.empty() && repeat_count.has_value())
+    return runScheduled(grid, dbg_opts, rating, profile, deadline);
+
   Stats stats;
   auto cleanup_step = std::make_unique<PropagateFixedCells>();
 
@@ -93,7 +171,13 @@ Stats Block::runOnGrid(Grid *const grid, const DebugOptions &dbg_opts) {
     for (int i = 0; i <= repeat_count.value_or(0); i++) {
       stats.modified = false;
       for (auto *step : steps) {
-        stats.modified |= runStep(grid, step, dbg_opts);
+        if (hasPassed(deadline)) {
+          stats.timed_out = true;
+          stats.is_complete = checkIsGridComplete(grid);
+          return stats;
+        }
+
+        stats.modified |= runStep(grid, step, dbg_opts, rating, profile);
 
         stats.num_steps++;
 
@@ -105,7 +189,8 @@ Stats Block::runOnGrid(Grid *const grid, const DebugOptions &dbg_opts) {
 
         // Do some fixed-cell cleanup
         cleanup_step->setWorkList(step->getChanged());
-        stats.modified |= runStep(grid, cleanup_step.get(), dbg_opts);
+        stats.modified |=
+            runStep(grid, cleanup_step.get(), dbg_opts, rating, profile);
 
         // If the step has made any modifications, start from the beginning.
         // This limits the amount of times we run expensive steps.
@@ -125,12 +210,14 @@ Stats Block::runOnGrid(Grid *const grid, const DebugOptions &dbg_opts) {
 
   for (int i = 0; i <= repeat_count.value_or(0); i++) {
     for (auto &b : blocks) {
-      stats |= b->runOnGrid(grid, dbg_opts);
+      stats |= b->runOnGrid(grid, dbg_opts, rating, profile, deadline);
+      if (stats.timed_out)
+        break;
     }
 
     stats.is_complete |= checkIsGridComplete(grid);
 
-    if (!stats.modified || stats.is_complete) {
+    if (!stats.modified || stats.is_complete || stats.timed_out) {
       return stats;
     }
   }
@@ -138,6 +225,13 @@ Stats Block::runOnGrid(Grid *const grid, const DebugOptions &dbg_opts) {
   return stats;
 }
 
+void Block::resetSteps() {
+  for (auto *step : steps)
+    step->reset();
+  for (auto &b : blocks)
+    b->resetSteps();
+}
+
 bool Block::addStep(const char *id, StepIDMap &step_map) {
   if (step_map.find(id) == step_map.end()) {
     std::cerr << "Could not add step '" << id << "'\n";
@@ -182,14 +276,16 @@ bool Strategy::initializeWithSteps(const std::vector<std::string> &to_run,
   return err;
 }
 
+void Strategy::resetSteps() {
+  if (main_block)
+    main_block->resetSteps();
+}
+
 Stats Strategy::solveGrid(Grid *const grid, const DebugOptions &dbg_opts) {
-  auto start = std::chrono::steady_clock::now();
-  Stats stats = main_block->runOnGrid(grid, dbg_opts);
-  if (TIME) {
-    auto end = std::chrono::steady_clock::now();
-    auto diff_ms =
-        std::chrono::duration<double, std::milli>(end - start).count();
-    std::cout << "Took " << diff_ms << "ms in total\n";
-  }
+  const Clock::time_point start = profile ? Clock::now() : Clock::time_point{};
+  Stats stats =
+      main_block->runOnGrid(grid, dbg_opts, rating, profile, deadline);
+  if (profile)
+    profile->recordRun("solve-grid", msSince(start));
   return stats;
 }
@@ -2,7 +2,9 @@
 #define COLUMBO_STRATEGY_H
 
 #include <cassert>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <unordered_set>
 #include <vector>
 
@@ -10,10 +12,13 @@
 #include "step.h"
 #include "utils.h"
 #include "fixed_cell_cleanup.h"
+#include "profile.h"
+#include "rating.h"
 
 extern bool DEBUG;
-extern bool TIME;
-extern bool USE_COLOUR;
+// Solving options. These are per-thread so that grids can be solved in
+// parallel.
+extern thread_local bool USE_COLOUR;
 
 struct Stats {
   unsigned num_steps = 0;
@@ -21,16 +26,22 @@ struct Stats {
 
   bool modified = false;
   bool is_complete = false;
+  // Solving stopped early because the strategy's deadline passed.
+  bool timed_out = false;
 
   Stats operator|=(const Stats &other) {
     num_steps += other.num_steps;
     num_useful_steps += other.num_useful_steps;
     modified |= other.modified;
     is_complete |= other.is_complete;
+    timed_out |= other.timed_out;
     return *this;
   }
 };
 
+// A time by which solving should stop, if any.
+using SolveDeadline = std::optional<std::chrono::steady_clock::time_point>;
+
 struct Block {
   std::optional<int> repeat_count;
   std::vector<ColumboStep*> steps;
@@ -41,17 +52,38 @@ struct Block {
 
   bool addStep(const char *id, StepIDMap &step_map);
 
-  Stats runOnGrid(Grid *const grid, const DebugOptions &dbg_opts);
+  void resetSteps();
+
+  Stats runOnGrid(Grid *const grid, const DebugOptions &dbg_opts,
+                  Rating *rating = nullptr, Profile *profile = nullptr,
+                  SolveDeadline deadline = std::nullopt);
+
+private:
+  Stats runScheduled(Grid *const grid, const DebugOptions &dbg_opts,
+                     Rating *rating, Profile *profile, SolveDeadline deadline);
 };
 
 struct Strategy {
   std::unique_ptr<Block> main_block;
+  // If set, records every step which makes progress while solving.
+  Rating *rating = nullptr;
+  // If set, times and counts every step run while solving.
+  Profile *profile = nullptr;
+  // If set, stops solving between steps once this time has passed.
+  SolveDeadline deadline;
 
   bool initializeDefault(StepIDMap &steps);
   bool initializeWithSteps(const std::vector<std::string> &to_run,
                            StepIDMap &steps);
 
+  // Forgets any per-grid state held by the steps, e.g. before solving a new
+  // grid or after restoring a snapshot.
+  void resetSteps();
+
   Stats solveGrid(Grid *const grid, const DebugOptions &dbg_opts);
 };
 
+// Removes cage combinations made impossible by changes to the given cells.
+void cleanUpCageCombos(Grid *const grid, CellSet const &changed);
+
 #endif // COLUMBO_STRATEGY_H
@@ -7,13 +7,14 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <unordered_set>
 
 #include <curses.h>
 
-bool USE_COLOUR = true;
+thread_local bool USE_COLOUR = true;
 
 static std::array<std::array<CellBorders, 9>, 9> borders;
 
@@ -114,7 +115,7 @@ int main(int argc, char **argv) {
   } else {
     for (unsigned y = 0; y < 9; y++) {
       for (unsigned x = 0; x < 9; x++) {
-        auto cage = std::make_unique<Cage>(0u);
+        auto cage = grid->arena.make<Cage>(0u);
         cage->addCell(grid.get(), grid->cells[y][x].coord);
         grid->cages.push_back(std::move(cage));
       }
@@ -245,7 +246,7 @@ int main(int argc, char **argv) {
       if (sum_mode && old_cage->sum < 10)
         old_cage->sum = old_cage->sum * 10 + static_cast<unsigned>(val);
       else if (candidate_mode && val != 0) {
-        old_cell->candidates[static_cast<size_t>(val - 1)].flip();
+        old_cell->candidates.flip(static_cast<size_t>(val - 1));
       }
       continue;
     }
@@ -291,9 +292,8 @@ int main(int argc, char **argv) {
     Cell *new_cell = grid->getCell(new_cursor);
     auto it = std::find_if(
         std::begin(grid->cages), std::end(grid->cages),
-        [new_cell](const std::unique_ptr<Cage> &cage) {
-          return std::find(std::begin(cage->cells), std::end(cage->cells),
-                           new_cell) != std::end(cage->cells);
+        [new_cell](const ArenaPtr<Cage> &cage) {
+          return cage->contains(new_cell);
         });
     assert(it != std::end(grid->cages));
 
@@ -314,18 +314,19 @@ int main(int argc, char **argv) {
       if (old_cage_cells.size() != new_cage_cells.size() ||
           old_cage_cells.size() != old_cage->size()) {
         // Create a new cage for the 'new' cells
-        auto cage = std::make_unique<Cage>(0u);
+        auto cage = grid->arena.make<Cage>(0u);
         for (auto *cell : new_cage_cells) {
           cage->addCell(grid.get(), cell->coord);
           grid->getCell(cell->coord)->cage = cage.get();
         }
         // Erase the 'new' cells from the 'old' cage
-        old_cage->cells.erase(
-            std::remove_if(std::begin(*old_cage), std::end(*old_cage),
-                           [&new_cage_cells](Cell *cell) {
-                             return new_cage_cells.count(cell) != 0;
-                           }),
-            std::end(*old_cage));
+        std::vector<Cell *> old_cells;
+        std::copy_if(std::begin(*old_cage), std::end(*old_cage),
+                     std::back_inserter(old_cells),
+                     [&new_cage_cells](Cell *cell) {
+                       return new_cage_cells.count(cell) == 0;
+                     });
+        old_cage->cells.assign(std::move(old_cells));
         // Push back this new cage
         grid->cages.push_back(std::move(cage));
       }
@@ -0,0 +1,257 @@
+#include "cli.h"
+#include "generator.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+static void print_help() {
+  std::cout << R"(
+    COLUMBO-GEN: A generator of killers. Of killer sudokus.
+
+    Usage:
+      columbo-gen [option]
+
+    Options:
+      -h                                   Print help and exit
+      -n    --count <N>                    Generate <N> sudokus (default 1)
+            --seed <seed>                  Generate the sudokus for <seed>.
+                                             The same seed always gives the
+                                             same sudokus. Random by default
+      -j    --jobs <N>                     Generate using <N> threads. 0 uses
+                                             one per hardware thread.
+      -o    --output <directory>           Write each sudoku to its own file
+                                             in <directory>, printing one line
+                                             per sudoku. By default sudokus
+                                             are printed to stdout
+            --cage-sizes w1,w2,..,w9       Relative weights of each cage size
+                                             (default 0,30,35,20,10,5,0,0,0)
+            --cage-sums <min>-<max>        Keep every cage's sum in range
+            --difficulty <level>           Only keep sudokus rated <level>:
+                                             easy, moderate, hard, expert or
+                                             search (needs guessing)
+            --max-attempts <N>             Give up on a sudoku after trying
+                                             <N> layouts of cages (default
+                                             1000)
+            --search-guesses <N>           Give up proving a sudoku unique
+                                             after <N> guesses (default 50000)
+      -q    --quiet                        Print nothing but the sudokus
+
+  )";
+}
+
+static bool parseUnsigned(const char *str, unsigned long long &val) {
+  char *end = nullptr;
+  val = std::strtoull(str, &end, 10);
+  return end == str || *end != '\0';
+}
+
+static void writePuzzle(std::ostream &os, GeneratedPuzzle &puzzle,
+                        std::uint64_t seed, std::uint64_t index) {
+  os << "# Generated by columbo-gen --seed " << seed << " (sudoku " << index
+     << ")\n";
+  os << "# Difficulty: " << getDifficultyName(puzzle.difficulty) << "\n";
+  os << "# Solution: ";
+  for (unsigned digit : puzzle.solution)
+    os << digit;
+  os << "\n";
+  puzzle.grid->writeToFile(os);
+}
+
+struct GenerateResult {
+  std::optional<GeneratedPuzzle> puzzle;
+  double time_ms = 0;
+};
+
+int main(int argc, char *argv[]) {
+  unsigned long long count = 1;
+  std::uint64_t seed = std::random_device{}();
+  unsigned num_jobs = 1;
+  const char *out_dir = nullptr;
+  bool quiet = false;
+  GeneratorOptions opts;
+
+  for (int i = 1; i < argc; i++) {
+    const char *opt = argv[i];
+    // Every option but these takes a value.
+    if (isOpt(opt, "-h", "--help")) {
+      print_help();
+      return 0;
+    }
+    if (isOpt(opt, "-q", "--quiet")) {
+      quiet = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "Expected a value to option '" << opt << "'...\n";
+      return 1;
+    }
+    const char *val = argv[++i];
+
+    unsigned long long num = 0;
+    if (isOpt(opt, "-n", "--count")) {
+      if (parseUnsigned(val, count)) {
+        std::cerr << "Invalid count '" << val << "'...\n";
+        return 1;
+      }
+    } else if (isOpt(opt, "", "--seed")) {
+      if (parseUnsigned(val, num)) {
+        std::cerr << "Invalid seed '" << val << "'...\n";
+        return 1;
+      }
+      seed = num;
+    } else if (isOpt(opt, "-j", "--jobs")) {
+      if (parseUnsigned(val, num)) {
+        std::cerr << "Invalid number of jobs '" << val << "'...\n";
+        return 1;
+      }
+      num_jobs = num ? static_cast<unsigned>(num)
+                     : std::max(1u, std::thread::hardware_concurrency());
+    } else if (isOpt(opt, "-o", "--output")) {
+      out_dir = val;
+    } else if (isOpt(opt, "", "--cage-sizes")) {
+      std::string_view weights = val;
+      opts.size_weights.fill(0);
+      unsigned total = 0;
+      for (unsigned size = 1; size <= 9 && !weights.empty(); size++) {
+        std::string weight{weights.substr(0, weights.find(','))};
+        weights.remove_prefix(std::min(weights.size(), weight.size() + 1));
+        if (parseUnsigned(weight.c_str(), num)) {
+          std::cerr << "Invalid cage size weight '" << weight << "'...\n";
+          return 1;
+        }
+        opts.size_weights[size] = static_cast<unsigned>(num);
+        total += opts.size_weights[size];
+      }
+      if (!weights.empty() || total == 0) {
+        std::cerr << "Invalid cage sizes '" << val << "'...\n";
+        return 1;
+      }
+    } else if (isOpt(opt, "", "--cage-sums")) {
+      std::string_view range = val;
+      auto dash = range.find('-');
+      std::string min{range.substr(0, dash)};
+      std::string max{dash == std::string_view::npos ? ""
+                                                     : range.substr(dash + 1)};
+      unsigned long long min_sum = 0, max_sum = 0;
+      if (parseUnsigned(min.c_str(), min_sum) ||
+          parseUnsigned(max.c_str(), max_sum) || min_sum > max_sum ||
+          max_sum > 45) {
+        std::cerr << "Invalid cage sums '" << val << "'...\n";
+        return 1;
+      }
+      opts.min_sum = static_cast<unsigned>(min_sum);
+      opts.max_sum = static_cast<unsigned>(max_sum);
+    } else if (isOpt(opt, "", "--difficulty")) {
+      opts.difficulty = parseDifficulty(val);
+      if (!opts.difficulty) {
+        std::cerr << "Unknown difficulty '" << val << "'...\n";
+        return 1;
+      }
+    } else if (isOpt(opt, "", "--max-attempts")) {
+      if (parseUnsigned(val, num) || num == 0) {
+        std::cerr << "Invalid number of attempts '" << val << "'...\n";
+        return 1;
+      }
+      opts.max_attempts = static_cast<unsigned>(num);
+    } else if (isOpt(opt, "", "--search-guesses")) {
+      if (parseUnsigned(val, num) || num == 0) {
+        std::cerr << "Invalid number of search guesses '" << val << "'...\n";
+        return 1;
+      }
+      opts.max_search_guesses = static_cast<unsigned>(num);
+    } else {
+      std::cerr << "Unknown option '" << opt << "'...\n";
+      return 1;
+    }
+  }
+
+  if (out_dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(out_dir, ec);
+    if (ec) {
+      std::cerr << "Could not create directory '" << out_dir << "'...\n";
+      return 1;
+    }
+  }
+
+  // Each sudoku is generated from its own index, so the output doesn't depend
+  // on the number of threads. Results are printed in order as they come in.
+  std::vector<GenerateResult> results(count);
+  std::vector<bool> is_done(count, false);
+  std::atomic<std::size_t> next_index = 0;
+  std::mutex results_mutex;
+  std::condition_variable results_cv;
+
+  auto worker = [&]() {
+    Generator generator(opts);
+    for (std::size_t i = next_index++; i < count; i = next_index++) {
+      GenerateResult result;
+      auto start = std::chrono::steady_clock::now();
+      result.puzzle = generator.generate(seed, i);
+      auto end = std::chrono::steady_clock::now();
+      result.time_ms =
+          std::chrono::duration<double, std::milli>(end - start).count();
+      {
+        std::lock_guard<std::mutex> lock(results_mutex);
+        results[i] = std::move(result);
+        is_done[i] = true;
+      }
+      results_cv.notify_one();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned j = 0; j < num_jobs; j++)
+    workers.emplace_back(worker);
+
+  int ret = 0;
+  for (std::size_t i = 0; i < count; i++) {
+    GenerateResult result;
+    {
+      std::unique_lock<std::mutex> lock(results_mutex);
+      results_cv.wait(lock, [&is_done, i]() { return is_done[i]; });
+      result = std::move(results[i]);
+    }
+
+    if (!result.puzzle) {
+      std::cerr << "Could not generate sudoku " << i << " within "
+                << opts.max_attempts << " attempts...\n";
+      ret = 1;
+      continue;
+    }
+
+    if (!out_dir) {
+      if (i)
+        std::cout << "\n";
+      writePuzzle(std::cout, *result.puzzle, seed, i);
+      continue;
+    }
+
+    auto path = std::filesystem::path(out_dir) /
+                (std::to_string(seed) + "-" + std::to_string(i) + ".txt");
+    std::ofstream out_file(path);
+    if (!out_file.is_open()) {
+      std::cerr << "Could not open file '" << path.string() << "'...\n";
+      ret = 1;
+      continue;
+    }
+    writePuzzle(out_file, *result.puzzle, seed, i);
+    if (!quiet)
+      std::cout << getDifficultyName(result.puzzle->difficulty) << ' '
+                << result.puzzle->num_attempts << " attempts "
+                << result.time_ms << "ms " << path.string() << '\n';
+  }
+
+  for (auto &t : workers)
+    t.join();
+
+  return ret;
+}
@@ -2,22 +2,78 @@
 
 #include <sstream>
 
-bool USE_ROWCOL = true;
+// COLUMBO_NO_SSE2 (the COLUMBO_USE_SSE2=OFF build) forces the portable
+// fallback, so it can be tested on targets which do have SSE2.
+#if defined(__SSE2__) && !defined(COLUMBO_NO_SSE2)
+#define COLUMBO_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+thread_local bool USE_ROWCOL = true;
 
 CellCountMaskArray collectCellCountMaskInfo(const House &house) {
   CellCountMaskArray cell_masks{};
   for (const auto &cell : house) {
-    const auto &candidates = cell->candidates;
-    for (std::size_t i = 0; i < 9; ++i) {
-      if (candidates[i]) {
-        cell_masks[i] |= (1 << house.getLinearID(cell));
-      }
-    }
+    const Mask cell_bit = 1 << house.getLinearID(cell);
+    for (unsigned i : cell->candidates)
+      cell_masks[i] |= cell_bit;
   }
   return cell_masks;
 }
 
-Printable printIntList(IntList const &list) {
+static uint16_t getBits(Mask m) { return static_cast<uint16_t>(m.to_ulong()); }
+
+#if defined(COLUMBO_HAS_SSE2)
+// Transposes the house's candidates a value at a time: the first eight cells
+// go in one 16-bit lane each, and shifting the value's bit up to each lane's
+// sign bit lets movemask pick out all eight at once.
+static void collectHouse(CandidateArray const &candidates,
+                         std::array<CellIdx, 9> const &house_cells,
+                         CellCountMaskArray &cell_masks) {
+  const __m128i lanes = _mm_setr_epi16(
+      getBits(candidates[house_cells[0]]), getBits(candidates[house_cells[1]]),
+      getBits(candidates[house_cells[2]]), getBits(candidates[house_cells[3]]),
+      getBits(candidates[house_cells[4]]), getBits(candidates[house_cells[5]]),
+      getBits(candidates[house_cells[6]]),
+      getBits(candidates[house_cells[7]]));
+  const unsigned last = getBits(candidates[house_cells[8]]);
+  for (unsigned i = 0; i < 9; i++) {
+    const __m128i shifted = _mm_sll_epi16(lanes, _mm_cvtsi32_si128(15 - i));
+    // Signed saturation keeps the sign bit when narrowing to bytes.
+    const unsigned first_eight =
+        _mm_movemask_epi8(_mm_packs_epi16(shifted, shifted)) & 0xFF;
+    cell_masks[i] = first_eight | (((last >> i) & 1) << 8);
+  }
+}
+#else
+static void collectHouse(CandidateArray const &candidates,
+                         std::array<CellIdx, 9> const &house_cells,
+                         CellCountMaskArray &cell_masks) {
+  cell_masks = {};
+  for (unsigned pos = 0; pos < 9; pos++) {
+    const Mask cell_bit = 1 << pos;
+    for (unsigned i : candidates[house_cells[pos]])
+      cell_masks[i] |= cell_bit;
+  }
+}
+#endif
+
+CellCountMaskArray collectCellCountMaskInfo(CandidateArray const &candidates,
+                                            unsigned house_idx) {
+  CellCountMaskArray cell_masks;
+  collectHouse(candidates, HouseCells[house_idx], cell_masks);
+  return cell_masks;
+}
+
+HouseCellCountMasks
+collectHouseCellCountMasks(CandidateArray const &candidates) {
+  HouseCellCountMasks house_masks;
+  for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++)
+    collectHouse(candidates, HouseCells[house_idx], house_masks[house_idx]);
+  return house_masks;
+}
+
+Printable printIntList(Permutation list) {
   return Printable([list](std::ostream &os) {
     bool sep = false;
     os << "[";
@@ -30,7 +86,7 @@ Printable printIntList(IntList const &list) {
 }
 
 Printable
-printAnnotatedIntList(IntList const &list,
+printAnnotatedIntList(Permutation list,
                       std::unordered_map<unsigned, char> const &symbol_map) {
   return Printable([list, symbol_map](std::ostream &os) {
     bool sep = false;
@@ -4,7 +4,7 @@
 #include "defs.h"
 #include "printable.h"
 
-extern bool USE_ROWCOL;
+extern thread_local bool USE_ROWCOL;
 
 static inline const char *getRowID(unsigned id, bool use_rowcol) {
   switch (id) {
@@ -34,10 +34,18 @@ static inline const char *getRowID(unsigned id, bool use_rowcol) {
 using CellCountMaskArray = std::array<Mask, 9>;
 
 CellCountMaskArray collectCellCountMaskInfo(const House &house);
+CellCountMaskArray collectCellCountMaskInfo(CandidateArray const &candidates,
+                                            unsigned house_idx);
 
-Printable printIntList(IntList const &list);
+// The cell count masks of every house, indexed by house.
+using HouseCellCountMasks = std::array<CellCountMaskArray, NumHouses>;
+
+HouseCellCountMasks
+collectHouseCellCountMasks(CandidateArray const &candidates);
+
+Printable printIntList(Permutation list);
 Printable
-printAnnotatedIntList(IntList const &list,
+printAnnotatedIntList(Permutation list,
                       std::unordered_map<unsigned, char> const &symbol_map);
 
 #endif // COLUMBO_UTILS_H
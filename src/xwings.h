@@ -5,6 +5,7 @@
 #include "defs.h"
 #include "nakeds.h"
 #include "step.h"
+#include "utils.h"
 #include <cassert>
 #include <optional>
 
@@ -46,13 +47,20 @@ struct XWingsStep : ColumboStep {
       }
     }
 
+    HouseCellCountMasks house_masks =
+        collectHouseCellCountMasks(grid->candidates);
     for (std::size_t i = 0, e = grid->rows.size(); i < e; ++i) {
       for (const auto &n : naked_pairs_per_row[i]) {
         // Search the next rows for matching naked pairs
         for (std::size_t j = i + 1; j < e; ++j) {
           for (const auto &m : naked_pairs_per_row[j]) {
-            if (auto xwing = getXWing(n, m))
-              modified |= runOnXWing(grid, *xwing, debug);
+            auto xwing = getXWing(n, m);
+            if (!xwing || !hasEliminations(house_masks, *xwing))
+              continue;
+            if (runOnXWing(grid, *xwing, debug)) {
+              modified = true;
+              house_masks = collectHouseCellCountMasks(grid->candidates);
+            }
           }
         }
       }
@@ -67,6 +75,20 @@ struct XWingsStep : ColumboStep {
   const char *getName() const override { return "X-Wings"; }
 
 private:
+  // Whether either column of the x-wing holds one of its values outside of
+  // the x-wing's rows.
+  static bool hasEliminations(HouseCellCountMasks const &house_masks,
+                              const XWing &xwing) {
+    const Mask rows = (1 << xwing.p1.first.row) | (1 << xwing.p2.first.row);
+    for (unsigned col : {xwing.p1.first.col, xwing.p1.second.col}) {
+      CellCountMaskArray const &cell_masks = house_masks[colHouseIndex(col)];
+      for (unsigned i : xwing.mask)
+        if ((cell_masks[i] & ~rows).any())
+          return true;
+    }
+    return false;
+  }
+
   bool runOnXWing(Grid *const grid, const XWing &xwing, bool debug) {
     bool modified = false;
     bool printed_xwing = false;
@@ -90,7 +112,7 @@ private:
             }
           }
           modified = true;
-          changed.insert(c);
+          changed.insert(c->getIndex());
         }
       }
     }
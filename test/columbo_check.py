@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 
 import sys
+import re
 import argparse
 from difflib import unified_diff
 
@@ -17,6 +18,9 @@ def main():
 
     parser.add_argument('-input-file', nargs='?',
                         type=argparse.FileType('r'), default=sys.stdin)
+    parser.add_argument('-mask', action='append', default=[],
+                        help="replace matches of this regex in the input "
+                             "with '*' before checking it")
     parser.add_argument('check_file', type=argparse.FileType('r'))
 
     args = parser.parse_args()
@@ -24,6 +28,8 @@ def main():
     errcode = 0
     check_lines = list(map(strip, filter(is_ignored_line, args.check_file.readlines())))
     input_lines = list(map(strip, filter(is_ignored_line, args.input_file.readlines())))
+    for mask in args.mask:
+        input_lines = [re.sub(mask, '*', line) for line in input_lines]
     for line in unified_diff(check_lines, input_lines,
                              fromfile='check_file', tofile='input'):
         errcode = 1
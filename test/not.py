@@ -0,0 +1,22 @@
+#!/usr/bin/env python3
+
+# Runs a command and inverts its exit status, for RUN lines which expect
+# columbo to fail. Like lit's 'not', a crash is never a success.
+
+import sys
+import subprocess
+
+
+def main():
+    if len(sys.argv) < 2:
+        print('usage: not.py <command> [args...]', file=sys.stderr)
+        return 2
+    retcode = subprocess.run(sys.argv[1:]).returncode
+    if retcode < 0:
+        print(f'Command crashed with signal {-retcode}', file=sys.stderr)
+        return 1
+    return 0 if retcode != 0 else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
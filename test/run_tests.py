@@ -39,11 +39,17 @@ def parse_run_lines(test_file, test_filename, columbo_binary_path):
             yield None
         line = line[6:].lstrip()
         for comp in map(str.lstrip, line.split('|')):
-            if not re.match(r'columbo(_check)?\b', comp):
+            if not re.match(r'(not\s+)?columbo(-gen|_check)?\b', comp):
                 raise ColumboRunLineException(f"Subcomponent '{comp}' does not "
-                                               "run either 'columbo' or 'columbo_check'")
+                                               "run 'columbo', 'columbo-gen' or 'columbo_check'")
+        # The generator is built alongside columbo.
+        line = re.sub(r'\bcolumbo-gen\b', '%G', line)
         line = re.sub(r'\bcolumbo\b', columbo_binary_path, line)
+        line = re.sub(r'%G', columbo_binary_path + '-gen', line)
         line = re.sub(r'\bcolumbo_check\b', f'{os.path.join(TEST_ROOT, "columbo_check.py")}', line)
+        # 'not <command>' expects the command to fail.
+        line = re.sub(r'(^|\|\s*)not\b', r'\1' + os.path.join(TEST_ROOT, 'not.py'),
+                      line)
         line = re.sub(r'%S', os.path.join(TEST_ROOT, os.path.dirname(test_filename)), line)
         line = re.sub(r'%s', os.path.join(TEST_ROOT, test_filename), line)
         line = re.sub(r'%%', '%', line)
@@ -0,0 +1,32 @@
+#include "framework.h"
+#include "arena.h"
+
+#include <cstdint>
+
+TEST(ArenaTest, RewindReusesMemory) {
+  Arena arena;
+  auto *first = static_cast<char *>(arena.allocate(3, 1));
+  auto *aligned = arena.allocate(8, 8);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 8, 0);
+  EXPECT_EQ(static_cast<char *>(aligned), first + 8);
+
+  Arena::Mark mark = arena.mark();
+  void *after_mark = arena.allocate(16, 8);
+  // Allocations larger than a chunk get one of their own.
+  void *large = arena.allocate(1 << 20, 8);
+  EXPECT_NE(large, nullptr);
+
+  arena.rewind(mark);
+  EXPECT_EQ(arena.allocate(16, 8), after_mark);
+  EXPECT_EQ(arena.allocate(1 << 20, 8), large);
+
+  arena.reset();
+  EXPECT_EQ(arena.allocate(3, 1), first);
+}
+
+TEST(ArenaTest, Make) {
+  Arena arena;
+  ArenaPtr<Cage> cage = arena.make<Cage>(12u);
+  EXPECT_EQ(cage->sum, 12);
+  EXPECT_TRUE(cage->empty());
+}
@@ -102,3 +102,33 @@ TEST_F(DefaultGridTest, CageSplitTest2) {
   EXPECT_EQ(cage.getMinValue(), 28);
   EXPECT_EQ(cage.getMaxValue(), 82);
 }
+
+// Membership, overlap and index queries must track the cells as they change.
+TEST_F(DefaultGridTest, CageMembership) {
+  Cage cage(0, true), other(0, true);
+  Cell *a = grid->getCell(Coord{0, 0});
+  Cell *b = grid->getCell(Coord{8, 8});
+  Cell *c = grid->getCell(Coord{4, 2});
+
+  cage.addCell(a);
+  cage.addCell(b);
+  other.addCell(c);
+  EXPECT_TRUE(cage.contains(b));
+  EXPECT_FALSE(cage.contains(c));
+  EXPECT_EQ(cage.indexOf(b), 1);
+  EXPECT_EQ(cage.indexOf(c), std::nullopt);
+  EXPECT_FALSE(cage.overlapsWith(&other));
+
+  other.addCell(b);
+  EXPECT_TRUE(cage.overlapsWith(&other));
+  EXPECT_EQ(other.getCellSet(), CellSet({c->getIndex(), b->getIndex()}));
+
+  cage.cells.assign({b});
+  EXPECT_FALSE(cage.contains(a));
+  EXPECT_EQ(cage.indexOf(b), 0);
+
+  cage.cells.assign({c, a});
+  EXPECT_EQ(cage.indexOf(a), 1);
+  EXPECT_FALSE(cage.contains(b));
+  EXPECT_EQ(cage.getCellSet(), CellSet({a->getIndex(), c->getIndex()}));
+}
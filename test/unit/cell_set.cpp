@@ -0,0 +1,39 @@
+#include "framework.h"
+#include "cell_set.h"
+
+#include <type_traits>
+#include <vector>
+
+static_assert(sizeof(CellSet) == 16);
+static_assert(std::is_trivially_copyable_v<CellSet>);
+
+TEST(CellSetTest, Basics) {
+  CellSet set{80, 3, 64, 63};
+  EXPECT_EQ(set.size(), 4);
+  EXPECT_TRUE(set.any());
+  EXPECT_TRUE(set.contains(63));
+  EXPECT_FALSE(set.contains(62));
+  EXPECT_EQ(set.first(), 3);
+
+  std::vector<unsigned> cells;
+  for (unsigned idx : set)
+    cells.push_back(idx);
+  EXPECT_EQ(cells, (std::vector<unsigned>{3, 63, 64, 80}));
+
+  set.erase(3);
+  set.erase(63);
+  EXPECT_EQ(set.first(), 64);
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  for (unsigned idx : set)
+    ADD_FAILURE() << "Unexpected cell " << idx;
+}
+
+TEST(CellSetTest, Houses) {
+  // Row 7 and column 1 meet at cell 64.
+  CellSet row = HouseCellSets[rowHouseIndex(7)];
+  CellSet col = HouseCellSets[colHouseIndex(1)];
+  EXPECT_EQ(row & col, CellSet{cellIndex(7, 1)});
+  EXPECT_EQ((row | col).size(), 17);
+  EXPECT_EQ(HouseCellSets[boxHouseIndex(8)].first(), cellIndex(6, 6));
+}
@@ -1,12 +1,13 @@
 #include "framework.h"
 #include "combinations.h"
+#include "strategy.h"
 
 TEST_F(DefaultGridTest, ComboBasics) {
   Cage cage(8);
 
   cage.addCell(grid.get(), Coord{0, 0});
   cage.addCell(grid.get(), Coord{1, 0});
-  auto combos = generateCageComboInfo(&cage);
+  auto combos = generateCageComboInfo(grid->arena, &cage);
 
   ASSERT_EQ(&cage, combos->cage);
   ASSERT_EQ(combos->size(), combos->getCombos().size());
@@ -40,7 +41,7 @@ TEST_F(DefaultGridTest, ComboKillerPairs) {
   cage.addCell(grid.get(), Coord{1, 0});
 
   // {17}, {26}, {35}
-  auto combos = generateCageComboInfo(&cage);
+  auto combos = generateCageComboInfo(grid->arena, &cage);
 
   auto killers = combos->computeKillerPairs(2);
 
@@ -63,3 +64,223 @@ TEST_F(DefaultGridTest, ComboKillerPairs) {
 
   EXPECT_EQ(expected_killers.empty(), true);
 }
+
+// The killers are only recomputed once the combos actually change.
+TEST_F(DefaultGridTest, ComboKillerCache) {
+  Cage cage(8);
+  cage.addCell(grid.get(), Coord{0, 0});
+  cage.addCell(grid.get(), Coord{1, 0});
+  // {17}, {26}, {35}
+  auto combos = generateCageComboInfo(grid->arena, &cage);
+  cage.cage_combos = combos.get();
+
+  combos->computeKillerPairs(3);
+  EXPECT_EQ(combos->getNumCachedKillers(), 1);
+
+  // Removing a candidate no permutation uses changes nothing.
+  Cell *cell = grid->getCell(Coord{0, 0});
+  cell->candidates.reset(3);
+  cleanUpCageCombos(grid.get(), CellSet{cell->getIndex()});
+  EXPECT_FALSE(combos->eraseCombos([](CageCombo const &) { return false; }));
+  EXPECT_EQ(combos->getNumCachedKillers(), 1);
+
+  // Removing 1 from the cell loses the [17] permutation, but not a combo.
+  cell->candidates.reset(0);
+  cleanUpCageCombos(grid.get(), CellSet{cell->getIndex()});
+  EXPECT_EQ(combos->size(), 3);
+  EXPECT_EQ(combos->getNumCachedKillers(), 0);
+
+  combos->computeKillerPairs(3);
+  EXPECT_TRUE(combos->eraseCombos(
+      [](CageCombo const &cc) { return cc.combo == Mask(0b01000001); }));
+  EXPECT_EQ(combos->getNumCachedKillers(), 0);
+  EXPECT_EQ(combos->computeKillerPairs(2).size(), 4);
+}
+
+TEST_F(DefaultGridTest, ComboKillerSetsLargeCage) {
+  Cage cage(10);
+  for (unsigned col = 0; col < 4; col++)
+    cage.addCell(grid.get(), Coord{0, col});
+
+  // 10/4 can only be {1234}, so each of its values is a killer on its own.
+  auto combos = generateCageComboInfo(grid->arena, &cage);
+  EXPECT_EQ(combos->computeKillerPairs(1),
+            MaskSet({0b0001, 0b0010, 0b0100, 0b1000}));
+
+  // Its first cell is one of {1234}, and its first two always use at least
+  // three of them.
+  CellMask first = 0b0001, first_two = 0b0011;
+  EXPECT_EQ(combos->computeKillerPairs(4, first), MaskSet({0b1111}));
+  EXPECT_EQ(combos->computeKillerPairs(3, first_two),
+            MaskSet({0b0111, 0b1011, 0b1101, 0b1110}));
+
+  Cage big(25);
+  for (unsigned col = 0; col < 5; col++)
+    big.addCell(grid.get(), Coord{1, col});
+  // 25/5 has many combos, and no pair of values hits all of them, but larger
+  // sets do.
+  auto big_combos = generateCageComboInfo(grid->arena, &big);
+  EXPECT_TRUE(big_combos->computeKillerPairs(2).empty());
+  MaskSet killers = big_combos->computeKillerPairs(9);
+  EXPECT_FALSE(killers.empty());
+  for (Mask m : killers)
+    for (CageCombo const &cc : *big_combos)
+      EXPECT_TRUE((cc.combo & m).any());
+}
+
+static std::vector<unsigned> firstValues(PermutationList const &perms) {
+  std::vector<unsigned> values;
+  for (Permutation perm : perms)
+    values.push_back(perm[0]);
+  return values;
+}
+
+TEST(PermutationListTest, Erase) {
+  PermutationList perms;
+  for (uint8_t i = 1; i <= 6; i++)
+    perms.push_back(IntList{i, uint8_t(i % 3 + 1), uint8_t(i + 2)});
+  ASSERT_EQ(perms.size(), 6);
+
+  // Copies share rows, but erase independently.
+  PermutationList copy = perms;
+  perms.eraseByIndex({0, 3, 4});
+  EXPECT_EQ(firstValues(perms), (std::vector<unsigned>{2, 3, 6}));
+  EXPECT_EQ(copy.size(), 6);
+
+  perms.eraseIf([](Permutation perm) { return perm[0] == 3; });
+  EXPECT_EQ(firstValues(perms), (std::vector<unsigned>{2, 6}));
+
+  // Cell 1 holds 2, 3, 1, 2, 3, 1 in turn.
+  copy.eraseValue(1, 2);
+  EXPECT_EQ(firstValues(copy), (std::vector<unsigned>{2, 3, 5, 6}));
+  copy.eraseValue(1, 3);
+  EXPECT_EQ(firstValues(copy), (std::vector<unsigned>{3, 6}));
+  // Compacted once fewer than a quarter of the rows are left.
+  copy.eraseValue(2, 5);
+  EXPECT_EQ(firstValues(copy), (std::vector<unsigned>{6}));
+  copy.eraseValue(1, 1);
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(copy.begin(), copy.end());
+}
+
+TEST(ComboTableTest, AllCombinations) {
+  // Every combination of distinct digits across killer cages of 2-9 cells.
+  unsigned num_combos = 0;
+  for (unsigned size = 2; size <= 9; size++)
+    for (unsigned sum = 0; sum <= 45; sum++)
+      num_combos += generateCageSubsetSums(
+                        sum, std::vector<Mask>(size, Mask::AllBits))
+                        .size();
+  EXPECT_EQ(num_combos, 502);
+
+  auto combos = generateCageSubsetSums(10, {0b000000111, 0b111111000});
+  ASSERT_EQ(combos.size(), 3);
+  EXPECT_EQ(combos[0].combo, Mask(0b001000100));
+  EXPECT_EQ(combos[2].combo, Mask(0b100000001));
+}
+
+static std::vector<IntList>
+allPermutations(std::vector<CageCombo> const &combos) {
+  std::vector<IntList> perms;
+  for (CageCombo const &cc : combos)
+    for (Permutation perm : cc.getPermutations())
+      perms.emplace_back(perm.begin(), perm.end());
+  std::sort(std::begin(perms), std::end(perms));
+  return perms;
+}
+
+// Each combo's values, repeated values and permutations, in order.
+static std::vector<std::tuple<unsigned long, unsigned long, std::vector<IntList>>>
+comboShapes(std::vector<CageCombo> const &combos) {
+  std::vector<std::tuple<unsigned long, unsigned long, std::vector<IntList>>>
+      shapes;
+  for (CageCombo const &cc : combos) {
+    std::vector<IntList> perms;
+    for (Permutation perm : cc.getPermutations())
+      perms.emplace_back(perm.begin(), perm.end());
+    std::sort(std::begin(perms), std::end(perms));
+    shapes.emplace_back(cc.combo.to_ulong(), cc.duplicates.to_ulong(), perms);
+  }
+  std::sort(std::begin(shapes), std::end(shapes));
+  return shapes;
+}
+
+TEST(ComboTableTest, ClashingCombos) {
+  // Cells 0-1 and 2-3 see each other, but neither pair sees the other.
+  std::vector<CellMask> clashes = {0b0010, 0b0001, 0b1000, 0b0100};
+  auto combos = *generateClashingCageCombos(
+      6, std::vector<Mask>(4, Mask::AllBits), clashes, 4);
+  // Each pair must then be {12}, in either order.
+  ASSERT_EQ(combos.size(), 1);
+  EXPECT_EQ(combos[0].combo, Mask(0b011));
+  EXPECT_EQ(combos[0].duplicates, Mask(0b011));
+  EXPECT_EQ(allPermutations(combos),
+            (std::vector<IntList>{
+                {1, 2, 1, 2}, {1, 2, 2, 1}, {2, 1, 1, 2}, {2, 1, 2, 1}}));
+  // Give up rather than write out more permutations than asked for.
+  EXPECT_FALSE(generateClashingCageCombos(
+      6, std::vector<Mask>(4, Mask::AllBits), clashes, 3));
+
+  // Compare against the exhaustive search on assorted cages.
+  uint32_t seed = 12345;
+  auto next = [&seed] { return (seed = seed * 1103515245 + 12345) >> 16; };
+  for (unsigned trial = 0; trial < 200; trial++) {
+    const unsigned size = 2 + next() % 5;
+    std::vector<Mask> possibles(size);
+    std::vector<CellMask> clashes(size);
+    unsigned max_sum = 0;
+    for (unsigned i = 0; i < size; i++) {
+      do
+        possibles[i] = Mask(next() & Mask::AllBits);
+      while (possibles[i].none());
+      max_sum += max_value(possibles[i]);
+      for (unsigned j = 0; j < i; j++)
+        if (next() % 3 == 0)
+          clashes[i][j] = clashes[j][i] = true;
+    }
+    const unsigned sum = size + next() % (max_sum - size + 1);
+    auto combos = generateClashingCageCombos(
+        sum, possibles, clashes, std::numeric_limits<std::size_t>::max());
+    ASSERT_TRUE(combos);
+    EXPECT_EQ(comboShapes(*combos),
+              comboShapes(
+                  generateSubsetSumsWithDuplicates(sum, possibles, clashes)))
+        << "trial " << trial;
+  }
+}
+
+TEST(ComboTableTest, SevenCellClashingCage) {
+  // Cells 0-3 see each other, as do cells 4-6, but neither group sees the
+  // other, so values may repeat across them.
+  std::vector<CellMask> clashes(7);
+  for (unsigned i = 0; i < 7; i++)
+    for (unsigned j = 0; j < 7; j++)
+      clashes[i][j] = i != j && (i < 4) == (j < 4);
+  std::vector<Mask> possibles(4, Mask(0b11111));
+  possibles.resize(7, Mask(0b1111));
+
+  auto combos = *generateClashingCageCombos(
+      20, possibles, clashes, std::numeric_limits<std::size_t>::max());
+  // Large cages are grouped by values just as small ones are, so the steps
+  // treat both alike.
+  EXPECT_EQ(comboShapes(combos),
+            comboShapes(generateSubsetSumsWithDuplicates(20, possibles,
+                                                         clashes)));
+  bool any_duplicates = false;
+  for (CageCombo const &cc : combos) {
+    // A combo repeats values exactly when it has fewer than one per cell.
+    EXPECT_EQ(cc.duplicates.any(), cc.combo.count() < 7);
+    any_duplicates |= cc.duplicates.any();
+    for (Permutation perm : cc.getPermutations()) {
+      Mask seen = 0, repeated = 0;
+      for (auto v : perm) {
+        if (seen[v - 1])
+          repeated.set(v - 1);
+        seen.set(v - 1);
+      }
+      EXPECT_EQ(seen, cc.combo);
+      EXPECT_EQ(repeated, cc.duplicates);
+    }
+  }
+  EXPECT_TRUE(any_duplicates);
+}
@@ -0,0 +1,55 @@
+#include "exact_cover.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+// The example from Knuth's "Dancing Links" paper, which has a single solution.
+TEST(ExactCoverTest, Knuth) {
+  ExactCover problem(7);
+  problem.addOption({2, 4, 5});
+  problem.addOption({0, 3, 6});
+  problem.addOption({1, 2, 5});
+  problem.addOption({0, 3});
+  problem.addOption({1, 6});
+  problem.addOption({3, 4, 6});
+
+  std::vector<std::vector<unsigned>> solutions;
+  bool stopped = problem.solve(
+      [&solutions](std::vector<unsigned> const &chosen) {
+        solutions.push_back(chosen);
+        std::sort(solutions.back().begin(), solutions.back().end());
+        return false;
+      },
+      []() { return false; });
+
+  EXPECT_FALSE(stopped);
+  ASSERT_EQ(solutions.size(), 1);
+  EXPECT_EQ(solutions[0], (std::vector<unsigned>{0, 3, 4}));
+}
+
+TEST(ExactCoverTest, StopEarly) {
+  // Every option covers both items, so each one is a solution.
+  ExactCover problem(2);
+  for (unsigned i = 0; i < 4; i++)
+    problem.addOption({0, 1});
+
+  unsigned num_solutions = 0;
+  bool stopped = problem.solve(
+      [&num_solutions](std::vector<unsigned> const &) {
+        return ++num_solutions == 2;
+      },
+      []() { return false; });
+  EXPECT_TRUE(stopped);
+  EXPECT_EQ(num_solutions, 2);
+
+  // The problem can be solved again once a search has been cut short.
+  num_solutions = 0;
+  stopped = problem.solve(
+      [&num_solutions](std::vector<unsigned> const &) {
+        ++num_solutions;
+        return false;
+      },
+      []() { return false; });
+  EXPECT_FALSE(stopped);
+  EXPECT_EQ(num_solutions, 4);
+}
@@ -11,7 +11,7 @@ protected:
     grid = std::make_unique<Grid>();
     for (unsigned y = 0; y < 9; y++) {
       for (unsigned x = 0; x < 9; x++) {
-        auto cage = std::make_unique<Cage>(0u);
+        auto cage = grid->arena.make<Cage>(0u);
         cage->addCell(grid.get(), grid->cells[y][x].coord);
         grid->cages.push_back(std::move(cage));
       }
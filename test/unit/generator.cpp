@@ -0,0 +1,88 @@
+#include "generator.h"
+#include "search.h"
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+TEST(GeneratorTest, Reproducible) {
+  GeneratorOptions opts;
+  Generator first(opts), second(opts);
+
+  auto a = first.generate(42, 3);
+  auto b = second.generate(42, 3);
+  ASSERT_TRUE(a && b);
+
+  std::stringstream a_ss, b_ss;
+  a->grid->writeToFile(a_ss);
+  b->grid->writeToFile(b_ss);
+  EXPECT_EQ(a_ss.str(), b_ss.str());
+  EXPECT_EQ(a->solution, b->solution);
+  EXPECT_EQ(a->difficulty, b->difficulty);
+  EXPECT_EQ(a->num_attempts, b->num_attempts);
+
+  // A different index gives a different puzzle.
+  auto c = first.generate(42, 5);
+  ASSERT_TRUE(c);
+  EXPECT_NE(a->solution, c->solution);
+}
+
+TEST(GeneratorTest, MatchesSolution) {
+  GeneratorOptions opts;
+  Generator generator(opts);
+  auto puzzle = generator.generate(42, 3);
+  ASSERT_TRUE(puzzle);
+
+  for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++) {
+    Mask seen;
+    for (unsigned idx : HouseCells[house_idx])
+      seen.set(puzzle->solution[idx] - 1);
+    EXPECT_TRUE(seen.all());
+  }
+
+  for (auto const &cage : puzzle->grid->cages) {
+    EXPECT_GT(cage->size(), 1);
+    Mask seen;
+    unsigned sum = 0;
+    for (auto const *cell : cage->cells) {
+      const unsigned digit = puzzle->solution[cell->getIndex()];
+      EXPECT_FALSE(seen[digit - 1]);
+      seen.set(digit - 1);
+      sum += digit;
+    }
+    EXPECT_EQ(sum, cage->sum);
+  }
+
+  // The puzzle is handed back unsolved.
+  for (unsigned idx = 0; idx < NumCells; idx++)
+    EXPECT_TRUE(puzzle->grid->candidates[idx].all());
+}
+
+TEST(GeneratorTest, UniqueSolution) {
+  GeneratorOptions opts;
+  Generator generator(opts);
+  auto puzzle = generator.generate(42, 3);
+  ASSERT_TRUE(puzzle);
+
+  StepList steps;
+  StepIDMap step_map;
+  initializeAllSteps(steps, step_map);
+  Strategy strat;
+  ASSERT_FALSE(strat.initializeDefault(step_map));
+
+  // Asking for a second solution proves there isn't one.
+  SearchOptions search_opts;
+  search_opts.max_solutions = 2;
+  search_opts.time_limit.reset();
+  SearchStats stats =
+      countSolutions(puzzle->grid.get(), strat, search_opts, DebugOptions{});
+  EXPECT_FALSE(stats.timed_out);
+  EXPECT_EQ(stats.num_solutions, 1);
+}
+
+TEST(GeneratorTest, DifficultyNames) {
+  for (auto difficulty : {Difficulty::Easy, Difficulty::Moderate,
+                          Difficulty::Hard, Difficulty::Expert,
+                          Difficulty::Search})
+    EXPECT_EQ(parseDifficulty(getDifficultyName(difficulty)), difficulty);
+  EXPECT_FALSE(parseDifficulty("impossible"));
+}
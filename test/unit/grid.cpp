@@ -0,0 +1,164 @@
+#include "framework.h"
+#include "combinations.h"
+#include "utils.h"
+
+// The index tables must agree with the houses built by the grid.
+TEST_F(DefaultGridTest, HouseTables) {
+  for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++) {
+    House *house = grid->getHouse(house_idx);
+    EXPECT_EQ(house->getIndex(), house_idx);
+    for (unsigned pos = 0; pos < 9; pos++) {
+      Cell *cell = (*house)[pos];
+      EXPECT_EQ(HouseCells[house_idx][pos], cell->getIndex());
+      EXPECT_EQ(house->getLinearID(cell), pos);
+    }
+  }
+}
+
+TEST_F(DefaultGridTest, CellTables) {
+  for (unsigned idx = 0; idx < NumCells; idx++) {
+    Cell *cell = grid->getCell(idx);
+    EXPECT_EQ(cell->getIndex(), idx);
+    EXPECT_EQ(&cell->candidates, &grid->candidates[idx]);
+    EXPECT_EQ(grid->getHouse(CellHouses[idx][0]), cell->row);
+    EXPECT_EQ(grid->getHouse(CellHouses[idx][1]), cell->col);
+    EXPECT_EQ(grid->getHouse(CellHouses[idx][2]), cell->box);
+
+    unsigned num_peers = 0;
+    for (unsigned other = 0; other < NumCells; other++) {
+      Cell *other_cell = grid->getCell(other);
+      bool is_peer = other != idx && (cell->row == other_cell->row ||
+                                      cell->col == other_cell->col ||
+                                      cell->box == other_cell->box);
+      if (!is_peer)
+        continue;
+      EXPECT_EQ(CellPeers[idx][num_peers], other);
+      num_peers++;
+    }
+    EXPECT_EQ(num_peers, CellPeers[idx].size());
+  }
+}
+
+// The all-houses kernel must agree with collecting each house on its own.
+// Build with COLUMBO_USE_SSE2=OFF to check the portable kernel too.
+TEST_F(DefaultGridTest, HouseCellCountMasks) {
+  auto check = [this](auto candidate_fn) {
+    for (unsigned idx = 0; idx < NumCells; idx++)
+      grid->candidates[idx] = candidate_fn(idx);
+    HouseCellCountMasks house_masks =
+        collectHouseCellCountMasks(grid->candidates);
+    for (unsigned house_idx = 0; house_idx < NumHouses; house_idx++) {
+      EXPECT_EQ(house_masks[house_idx],
+                collectCellCountMaskInfo(*grid->getHouse(house_idx)));
+      EXPECT_EQ(house_masks[house_idx],
+                collectCellCountMaskInfo(grid->candidates, house_idx));
+    }
+  };
+
+  check([](unsigned idx) { return Mask((idx * 37 + 11) % 512); });
+  check([](unsigned) { return Mask(0); });
+  check([](unsigned) { return Mask(Mask::AllBits); });
+  // A solved grid: one candidate per cell.
+  check([](unsigned idx) {
+    return Mask(1u << ((idx / 9 * 3 + idx / 27 + idx % 9) % 9));
+  });
+  // Only the last cell of each row, and only the highest value.
+  check([](unsigned idx) { return Mask(idx % 9 == 8 ? 1u << 8 : 0); });
+  uint32_t state = 12345;
+  for (unsigned i = 0; i < 20; i++)
+    check([&state](unsigned) {
+      state = state * 1664525 + 1013904223;
+      return Mask(state >> 23);
+    });
+}
+
+TEST_F(DefaultGridTest, SnapshotRestore) {
+  Cage cage(8);
+  cage.addCell(grid.get(), Coord{0, 0});
+  cage.addCell(grid.get(), Coord{1, 0});
+  grid->cage_combos.push_back(generateCageComboInfo(grid->arena, &cage));
+  CageComboInfo &combos = *grid->cage_combos.back();
+
+  grid->innies_and_outies.push_back(grid->arena.make<InnieOutieRegion>(
+      grid->arena, Coord{0, 0}, Coord{8, 0}));
+  InnieOutieRegion &region = *grid->innies_and_outies.back();
+  region.initialize(grid.get());
+  const unsigned known_sum = region.known_cage->sum;
+
+  GridSnapshot snap = grid->snapshot();
+
+  // Fix a cell, drop a combo and add a pseudo cage to the region.
+  grid->cells[0][0].candidates = 1 << 0;
+  combos.eraseCombos(
+      [](CageCombo const &cc) { return cc.combo == Mask(0b01000001); });
+  region.known_cage->sum += 5;
+  grid->pseudo_cages.push_back(grid->arena.make<Cage>(3, true));
+  grid->pseudo_cages.back()->cells.addCell(grid->getCell(Coord{2, 0}));
+  region.addPseudoCage(region.innies, grid->pseudo_cages.back().get());
+  EXPECT_EQ(grid->cells[2][0].pseudo_cages.size(), 1);
+  auto cages = grid->cells[2][0].all_cages();
+  EXPECT_EQ(std::vector<Cage *>(cages.begin(), cages.end()),
+            (std::vector<Cage *>{grid->cells[2][0].cage,
+                                 grid->pseudo_cages.back().get()}));
+  EXPECT_EQ(combos.size(), 2);
+
+  grid->restore(snap);
+
+  EXPECT_TRUE(grid->cells[0][0].candidates.all());
+  EXPECT_EQ(combos.size(), 3);
+  EXPECT_EQ(region.known_cage->sum, known_sum);
+  EXPECT_TRUE(region.innies.empty());
+  EXPECT_TRUE(grid->cells[2][0].pseudo_cages.empty());
+
+  // The snapshot is unaffected by changes made after restoring it.
+  combos.eraseCombos([](CageCombo const &) { return true; });
+  grid->restore(snap);
+  EXPECT_EQ(combos.size(), 3);
+}
+
+TEST_F(DefaultGridTest, SnapshotRetiredRegion) {
+  grid->innies_and_outies.push_back(grid->arena.make<InnieOutieRegion>(
+      grid->arena, Coord{0, 0}, Coord{8, 0}));
+  InnieOutieRegion &region = *grid->innies_and_outies.back();
+  grid->pseudo_cages.push_back(grid->arena.make<Cage>(3, true));
+  grid->pseudo_cages.back()->cells.addCell(grid->getCell(Coord{2, 0}));
+  region.addPseudoCage(region.innies, grid->pseudo_cages.back().get());
+
+  GridSnapshot snap = grid->snapshot();
+
+  region.retire();
+  EXPECT_TRUE(grid->cells[2][0].pseudo_cages.empty());
+
+  grid->restore(snap);
+  EXPECT_TRUE(region.active);
+  EXPECT_EQ(grid->cells[2][0].pseudo_cages.size(), 1);
+}
+
+// Regions share pseudo cages, which stay registered with their cells while
+// any active region uses them.
+TEST_F(DefaultGridTest, SharedPseudoCage) {
+  grid->innies_and_outies.push_back(grid->arena.make<InnieOutieRegion>(
+      grid->arena, Coord{0, 0}, Coord{8, 0}));
+  grid->innies_and_outies.push_back(grid->arena.make<InnieOutieRegion>(
+      grid->arena, Coord{0, 0}, Coord{2, 2}));
+  InnieOutieRegion &col = *grid->innies_and_outies[0];
+  InnieOutieRegion &box = *grid->innies_and_outies[1];
+
+  grid->pseudo_cages.push_back(grid->arena.make<Cage>(3, true));
+  Cage *pseudo_cage = grid->pseudo_cages.back().get();
+  pseudo_cage->cells.addCell(grid->getCell(Coord{2, 0}));
+  col.addPseudoCage(col.innies, pseudo_cage);
+  box.addPseudoCage(box.large_innies, pseudo_cage);
+  EXPECT_EQ(grid->cells[2][0].pseudo_cages.size(), 1);
+
+  col.retire();
+  EXPECT_EQ(grid->cells[2][0].pseudo_cages.size(), 1);
+
+  GridSnapshot snap = grid->snapshot();
+  box.retire();
+  EXPECT_TRUE(grid->cells[2][0].pseudo_cages.empty());
+
+  grid->restore(snap);
+  EXPECT_EQ(grid->cells[2][0].pseudo_cages.size(), 1);
+  EXPECT_EQ(pseudo_cage->num_regions, 1);
+}
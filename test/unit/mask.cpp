@@ -0,0 +1,74 @@
+#include "framework.h"
+#include "mask.h"
+
+#include <type_traits>
+#include <vector>
+
+static_assert(sizeof(Mask) == 2);
+static_assert(std::is_trivially_copyable_v<Mask>);
+
+TEST(MaskTest, Basics) {
+  Mask m = 0b100010100;
+
+  EXPECT_EQ(m.count(), 3);
+  EXPECT_TRUE(m.any());
+  EXPECT_FALSE(m.none());
+  EXPECT_FALSE(m.all());
+  EXPECT_TRUE(m[2]);
+  EXPECT_FALSE(m[3]);
+
+  EXPECT_EQ(min_value(m), 3);
+  EXPECT_EQ(max_value(m), 9);
+
+  EXPECT_EQ((~m).count(), 6);
+  EXPECT_EQ(~m & m, Mask(0));
+  EXPECT_TRUE((~m | m).all());
+}
+
+// Asking for the values of an empty mask is a bug, but mustn't be undefined
+// once asserts are compiled out.
+TEST(MaskTest, EmptyMinMax) {
+#ifdef NDEBUG
+  EXPECT_EQ(min_value(Mask(0)), 0);
+  EXPECT_EQ(max_value(Mask(0)), 0);
+#else
+  EXPECT_DEATH(min_value(Mask(0)), "Unset mask");
+  EXPECT_DEATH(max_value(Mask(0)), "Unset mask");
+#endif
+}
+
+TEST(MaskTest, SingleBit) {
+  EXPECT_FALSE(Mask(0).hasSingleBit());
+  EXPECT_TRUE(Mask(0b1000).hasSingleBit());
+  EXPECT_FALSE(Mask(0b1010).hasSingleBit());
+
+  Grid grid;
+  Cell &cell = grid.cells[0][0];
+  EXPECT_EQ(cell.isFixed(), 0);
+  cell.candidates = 1 << 6;
+  EXPECT_EQ(cell.isFixed(), 7);
+}
+
+TEST(MaskTest, Iteration) {
+  std::vector<unsigned> bits;
+  for (unsigned i : Mask(0b110000011))
+    bits.push_back(i);
+
+  EXPECT_EQ(bits, (std::vector<unsigned>{0, 1, 7, 8}));
+
+  for (unsigned i : Mask(0))
+    ADD_FAILURE() << "Unexpected bit " << i;
+}
+
+TEST(MaskTest, SetAndReset) {
+  Mask m;
+  m.set(4);
+  EXPECT_EQ(m, Mask(0b10000));
+  m.flip(0);
+  EXPECT_EQ(m, Mask(0b10001));
+  m.reset(4);
+  EXPECT_EQ(m, Mask(0b1));
+  m.set();
+  EXPECT_TRUE(m.all());
+  EXPECT_EQ(m.to_ulong(), 0x1FF);
+}
@@ -0,0 +1,58 @@
+#include "framework.h"
+#include "mask_set.h"
+
+#include <type_traits>
+#include <vector>
+
+static_assert(sizeof(MaskSet) == 64);
+static_assert(std::is_trivially_copyable_v<MaskSet>);
+
+static std::vector<unsigned> toList(MaskSet const &set) {
+  std::vector<unsigned> masks;
+  for (Mask m : set)
+    masks.push_back(m.to_ulong());
+  return masks;
+}
+
+TEST(MaskSetTest, Basics) {
+  MaskSet set{0b100000000, 0b11, 0b111111111, 0b1000000};
+  EXPECT_EQ(set.size(), 4);
+  EXPECT_TRUE(set.any());
+  EXPECT_TRUE(set.contains(0b11));
+  EXPECT_FALSE(set.contains(0b10));
+  EXPECT_EQ(toList(set), (std::vector<unsigned>{0b11, 0b1000000, 0b100000000,
+                                                 0b111111111}));
+
+  set.erase(0b11);
+  EXPECT_EQ(toList(set),
+            (std::vector<unsigned>{0b1000000, 0b100000000, 0b111111111}));
+  EXPECT_EQ(set & MaskSet({0b1000000, 0b1}), MaskSet({0b1000000}));
+  EXPECT_EQ((set | MaskSet({0b1})).size(), 4);
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  for (Mask m : set)
+    ADD_FAILURE() << "Unexpected mask " << m.to_ulong();
+}
+
+TEST(MaskSetTest, Supersets) {
+  // {17}, {26}, {35}, {125}
+  MaskSet combos{0b001000001, 0b000100010, 0b000010100, 0b000010011};
+  EXPECT_EQ(toList(combos.supersetsOf(0b10)),
+            (std::vector<unsigned>{0b000010011, 0b000100010}));
+  EXPECT_TRUE(combos.anySupersetOf(0b000010001));
+  EXPECT_FALSE(combos.anySupersetOf(0b000000101));
+  EXPECT_EQ(combos.supersetsOf(0), combos);
+
+  EXPECT_EQ(combos.common(), Mask(0));
+  EXPECT_EQ(MaskSet({0b110, 0b011, 0b111}).common(), Mask(0b010));
+  EXPECT_EQ(MaskSet{}.common(), Mask(Mask::AllBits));
+}
+
+TEST(MaskSetTest, Transforms) {
+  MaskSet set{0b000000000, 0b000000101, 0b100000010};
+  EXPECT_EQ(set.complements(),
+            MaskSet({0b111111111, 0b111111010, 0b011111101}));
+  EXPECT_EQ(set.withValueAdded(1), MaskSet({0b000000010, 0b000000111}));
+  EXPECT_EQ(set.withValueAdded(8), MaskSet({0b100000000, 0b100000101}));
+  EXPECT_EQ((~set).size(), 509);
+}
@@ -0,0 +1,76 @@
+#include "profile.h"
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+TEST(ProfileTest, Aggregate) {
+  Profile profile;
+  for (unsigned i = 1; i <= 100; i++)
+    profile.recordRun("naked-pairs", i, i % 2, i % 2 ? 3 : 0);
+
+  StepProfile const &step = profile.steps["naked-pairs"];
+  EXPECT_EQ(step.num_runs, 100);
+  EXPECT_EQ(step.num_useful, 50);
+  EXPECT_EQ(step.num_cells_changed, 50);
+  EXPECT_EQ(step.num_eliminations, 150);
+  EXPECT_DOUBLE_EQ(step.getTotalMs(), 5050);
+  EXPECT_DOUBLE_EQ(step.getMeanMs(), 50.5);
+  // P99 is only known to the precision of the histogram's buckets.
+  EXPECT_NEAR(step.getP99Ms(), 99, 99 * 0.1);
+  EXPECT_GE(step.getP99Ms(), 99);
+
+  Profile other;
+  other.recordRun("naked-pairs", 1000, 2, 4);
+  other.recordRun("x-wings", 1);
+  profile.merge(other);
+  EXPECT_EQ(profile.steps["naked-pairs"].num_runs, 101);
+  EXPECT_EQ(profile.steps["naked-pairs"].num_cells_changed, 52);
+  EXPECT_NEAR(profile.steps["naked-pairs"].getP99Ms(), 100, 100 * 0.1);
+  EXPECT_DOUBLE_EQ(profile.steps["naked-pairs"].getTotalMs(), 6050);
+  EXPECT_EQ(profile.steps["x-wings"].num_useful, 0);
+}
+
+TEST(ProfileTest, Percentiles) {
+  StepProfile fast, slow;
+  // 990 quick runs and 10 slow ones: P99 is the slowest of the quick runs.
+  for (unsigned i = 0; i < 990; i++)
+    fast.recordTime(0.001 * (1 + i % 5));
+  for (unsigned i = 0; i < 10; i++)
+    slow.recordTime(50);
+  EXPECT_NEAR(fast.getP99Ms(), 0.005, 0.005 * 0.1);
+
+  fast.merge(slow);
+  EXPECT_EQ(fast.num_runs, 1000);
+  EXPECT_DOUBLE_EQ(fast.max_ms, 50);
+  EXPECT_NEAR(fast.getP99Ms(), 0.005, 0.005 * 0.1);
+  slow.recordTime(50);
+  fast.merge(slow);
+  EXPECT_DOUBLE_EQ(fast.getP99Ms(), 50);
+
+  // Times beyond the histogram's range are still bounded by the slowest run.
+  StepProfile extremes;
+  extremes.recordTime(0);
+  extremes.recordTime(1e9);
+  EXPECT_DOUBLE_EQ(extremes.getP99Ms(), 1e9);
+  EXPECT_EQ(extremes.time_buckets.front(), 1);
+  EXPECT_EQ(extremes.time_buckets.back(), 1);
+}
+
+TEST(ProfileTest, Write) {
+  Profile profile;
+  profile.recordRun("x-wings", 2, 1, 3);
+
+  std::stringstream csv;
+  profile.write(csv, ProfileFormat::CSV);
+  EXPECT_EQ(csv.str(), "step,runs,useful,cells_changed,candidates_removed,"
+                       "total_ms,mean_ms,p99_ms\n"
+                       "x-wings,1,1,1,3,2,2,2\n");
+
+  std::stringstream json;
+  profile.write(json, ProfileFormat::JSON);
+  EXPECT_EQ(json.str(), "{\n  \"steps\": [\n"
+                        "    {\"step\": \"x-wings\", \"runs\": 1, "
+                        "\"useful\": 1, \"cells_changed\": 1, "
+                        "\"candidates_removed\": 3, \"total_ms\": 2, "
+                        "\"mean_ms\": 2, \"p99_ms\": 2}\n  ]\n}\n");
+}
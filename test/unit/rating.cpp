@@ -0,0 +1,58 @@
+#include "generator.h"
+#include "rating.h"
+#include <gtest/gtest.h>
+
+TEST(RatingTest, Score) {
+  Rating rating;
+  EXPECT_EQ(rating.getHardestStep(), nullptr);
+  EXPECT_EQ(rating.getScore(), 0);
+
+  rating.recordStep("hidden-singles", 4);
+  rating.recordStep("hidden-singles", 2);
+  rating.recordStep("naked-pairs", 3);
+  rating.recordStep("fixed-cell-cleanup", 8);
+  EXPECT_EQ(rating.steps["hidden-singles"].num_useful, 2);
+  EXPECT_EQ(rating.steps["hidden-singles"].num_eliminations, 6);
+  EXPECT_STREQ(rating.getHardestStep(), "naked-pairs");
+  // 10 * 2 for the hardest step, then 2 * 1 + 1 * 2 + 1 * 0.
+  EXPECT_EQ(rating.getScore(), 24);
+
+  rating.recordSearch();
+  EXPECT_STREQ(rating.getHardestStep(), "search");
+  EXPECT_EQ(rating.getScore(), 114);
+}
+
+TEST(RatingTest, SolvedGrid) {
+  Generator generator(GeneratorOptions{});
+  auto puzzle = generator.generate(42, 3);
+  ASSERT_TRUE(puzzle);
+
+  StepList steps;
+  StepIDMap step_map;
+  initializeAllSteps(steps, step_map);
+  Strategy strat;
+  ASSERT_FALSE(strat.initializeDefault(step_map));
+
+  Rating rating;
+  strat.rating = &rating;
+  Stats stats = strat.solveGrid(puzzle->grid.get(), DebugOptions{});
+  ASSERT_TRUE(stats.is_complete);
+
+  // Every candidate but the solution's was eliminated by some step.
+  unsigned num_eliminations = 0;
+  for (auto const &[id, usage] : rating.steps)
+    num_eliminations += usage.num_eliminations;
+  EXPECT_EQ(num_eliminations, NumCells * 9 - NumCells);
+  EXPECT_NE(rating.getHardestStep(), nullptr);
+  // The generator rates puzzles the same way.
+  EXPECT_EQ(rating.getDifficulty(), puzzle->difficulty);
+}
+
+TEST(RatingTest, Difficulty) {
+  EXPECT_EQ(getStepDifficulty("hidden-singles"), Difficulty::Easy);
+  EXPECT_EQ(getStepDifficulty("innies-outies"), Difficulty::Moderate);
+  EXPECT_EQ(getStepDifficulty("x-wings"), Difficulty::Hard);
+  EXPECT_EQ(getStepDifficulty("conflicting-combos-hard"), Difficulty::Expert);
+  EXPECT_EQ(getStepDifficulty("search"), Difficulty::Search);
+  EXPECT_EQ(Rating().getDifficulty(), Difficulty::Easy);
+}
@@ -0,0 +1,33 @@
+#include "framework.h"
+#include "small_vector.h"
+
+#include <algorithm>
+#include <vector>
+
+TEST(SmallVectorTest, Basics) {
+  SmallVector<int, 2> vec;
+  EXPECT_TRUE(vec.empty());
+  int const *local = vec.data();
+
+  vec.push_back(1);
+  vec.push_back(2);
+  EXPECT_EQ(vec.data(), local);
+  // Outgrow the inline storage.
+  for (int i = 3; i <= 5; i++)
+    vec.push_back(i);
+  EXPECT_NE(vec.data(), local);
+  EXPECT_EQ(std::vector<int>(vec.begin(), vec.end()),
+            (std::vector<int>{1, 2, 3, 4, 5}));
+
+  vec.erase(std::remove_if(vec.begin(), vec.end(),
+                           [](int i) { return i % 2 == 0; }),
+            vec.end());
+  EXPECT_EQ(std::vector<int>(vec.begin(), vec.end()),
+            (std::vector<int>{1, 3, 5}));
+  vec.erase(vec.begin());
+  EXPECT_EQ(vec.size(), 2);
+  EXPECT_EQ(vec[0], 3);
+
+  vec.clear();
+  EXPECT_TRUE(vec.empty());
+}